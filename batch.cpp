@@ -0,0 +1,256 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+std::vector<std::string> CollectWorkloads(const std::vector<std::string> &paths)
+{
+    std::vector<std::string> files;
+
+    for (const std::string &path : paths)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error))
+        {
+            files.push_back(path);
+            continue;
+        }
+
+        std::vector<std::string> entries;
+        for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(path, error))
+        {
+            if (entry.is_regular_file(error))
+            {
+                entries.push_back(entry.path().string());
+            }
+        }
+        std::sort(entries.begin(), entries.end());
+        files.insert(files.end(), entries.begin(), entries.end());
+    }
+
+    return files;
+}
+
+// ----------------------------------   WORKER POOL   --------------------------------------
+
+void ForEachParallel(size_t count, unsigned threads, const std::function<void(size_t)> &work)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<size_t>(threads, std::max<size_t>(count, 1));
+
+    // workers pick the next index off a shared counter, so long tasks do not hold up a whole slice of the list
+    std::atomic<size_t> next(0);
+    auto Worker = [&]()
+    {
+        size_t index;
+        while ((index = next.fetch_add(1)) < count)
+        {
+            work(index);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; i++)
+    {
+        pool.emplace_back(Worker);
+    }
+    Worker();
+    for (std::thread &worker : pool)
+    {
+        worker.join();
+    }
+}
+
+static void SimulateWorkload(const SchedulerConfig &config, BatchResult &result)
+{
+    // each file gets a private scheduler, nothing is shared between the workers
+    Scheduler scheduler(config.policy, config.quantum);
+    ApplyConfig(scheduler, config);
+    result.loaded = scheduler.LoadFile(result.inputFilename) >= 0;
+    if (result.loaded)
+    {
+        scheduler.Run();
+    }
+    result.stats = scheduler.Stats();
+    result.p50Turnaround = scheduler.TurnaroundPercentile(0.5);
+    result.p99Turnaround = scheduler.TurnaroundPercentile(0.99);
+}
+
+std::vector<BatchResult> RunBatch(const SchedulerConfig &config, const std::vector<std::string> &files,
+                                  unsigned threads)
+{
+    std::vector<BatchResult> results(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        results[i].inputFilename = files[i];
+    }
+
+    ForEachParallel(results.size(), threads, [&](size_t index) { SimulateWorkload(config, results[index]); });
+
+    return results;
+}
+
+// ----------------------------------   RESULTS FILE   --------------------------------------
+
+static double Average(double total, int count)
+{
+    return count > 0 ? total / count : 0;
+}
+
+static std::string CsvField(const std::string &value)
+{
+    if (value.find_first_of(",\"\n") == std::string::npos)
+    {
+        return value;
+    }
+
+    std::string quoted = "\"";
+    for (char c : value)
+    {
+        quoted += c;
+        if (c == '"')
+        {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+static std::string JsonString(const std::string &value)
+{
+    std::string quoted = "\"";
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            // control characters are not allowed raw inside a JSON string
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+            quoted += escaped;
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+bool WriteBatchResults(const std::string &outputFilename, const SchedulerConfig &config,
+                       const std::vector<BatchResult> &results)
+{
+    // FAIR is reported together with the policy it runs inside the groups
+    std::string policy = config.policy;
+    if (policy == "FAIR")
+    {
+        policy += "/" + (config.innerPolicy.empty() ? std::string("RR") : config.innerPolicy);
+    }
+    // FCFS and SJF slice nothing, their quantum is left empty in CSV and null in JSON
+    std::string csvQuantum;
+    std::string jsonQuantum = "null";
+    if (config.quantum > 0)
+    {
+        std::ostringstream text;
+        text << config.quantum;
+        csvQuantum = jsonQuantum = text.str();
+    }
+
+    std::ofstream output(outputFilename);
+    if (!output.is_open())
+    {
+        return false;
+    }
+
+    bool json = outputFilename.size() >= 5 && outputFilename.compare(outputFilename.size() - 5, 5, ".json") == 0;
+
+    if (json)
+    {
+        output << "[\n";
+    }
+    else
+    {
+        output << "file,policy,quantum,status,processes,completed,dispatches,"
+               << "average_waiting_time,average_turnaround_time,total_time,"
+               << "cpu_utilization,device_utilization,throughput,context_switches,switch_overhead,"
+               << "admitted,rejected,deferrals,deprioritized,p50_turnaround_time,p99_turnaround_time\n";
+    }
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BatchResult &result = results[i];
+        const SchedulerStats &stats = result.stats;
+        double averageWaitTime = Average(stats.totalWaitingTime, stats.completed);
+        double averageTurnaroundTime = Average(stats.totalTurnaroundTime, stats.completed);
+
+        if (json)
+        {
+            output << "  {\"file\": " << JsonString(result.inputFilename)
+                   << ", \"policy\": " << JsonString(policy)
+                   << ", \"quantum\": " << jsonQuantum
+                   << ", \"status\": \"" << (result.loaded ? "ok" : "unreadable") << "\""
+                   << ", \"processes\": " << stats.processCount
+                   << ", \"completed\": " << stats.completed
+                   << ", \"dispatches\": " << stats.dispatches
+                   << ", \"average_waiting_time\": " << averageWaitTime
+                   << ", \"average_turnaround_time\": " << averageTurnaroundTime
+                   << ", \"total_time\": " << stats.time
+                   << ", \"cpu_utilization\": " << CpuUtilization(stats)
+                   << ", \"device_utilization\": " << DeviceUtilization(stats)
+                   << ", \"throughput\": " << Throughput(stats)
+                   << ", \"context_switches\": " << stats.contextSwitches
+                   << ", \"switch_overhead\": " << SwitchOverhead(stats)
+                   << ", \"admitted\": " << stats.admitted
+                   << ", \"rejected\": " << stats.rejected
+                   << ", \"deferrals\": " << stats.deferrals
+                   << ", \"deprioritized\": " << stats.deprioritized
+                   << ", \"p50_turnaround_time\": " << result.p50Turnaround
+                   << ", \"p99_turnaround_time\": " << result.p99Turnaround
+                   << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        else
+        {
+            output << CsvField(result.inputFilename) << ","
+                   << policy << ","
+                   << csvQuantum << ","
+                   << (result.loaded ? "ok" : "unreadable") << ","
+                   << stats.processCount << ","
+                   << stats.completed << ","
+                   << stats.dispatches << ","
+                   << averageWaitTime << ","
+                   << averageTurnaroundTime << ","
+                   << stats.time << ","
+                   << CpuUtilization(stats) << ","
+                   << DeviceUtilization(stats) << ","
+                   << Throughput(stats) << ","
+                   << stats.contextSwitches << ","
+                   << SwitchOverhead(stats) << ","
+                   << stats.admitted << ","
+                   << stats.rejected << ","
+                   << stats.deferrals << ","
+                   << stats.deprioritized << ","
+                   << result.p50Turnaround << ","
+                   << result.p99Turnaround << "\n";
+        }
+    }
+
+    if (json)
+    {
+        output << "]\n";
+    }
+
+    output.close();
+    return !output.fail();
+}
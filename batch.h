@@ -0,0 +1,38 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "scheduler.h"
+
+// ----------------------------------   BATCH MODE   --------------------------------------
+
+struct BatchResult
+{
+    std::string inputFilename;
+    bool loaded;               // false when the file could not be opened
+    SchedulerStats stats;
+    double p50Turnaround;
+    double p99Turnaround;
+};
+
+// expands directories into the regular files they contain, sorted by name;
+// plain files are kept in the order given
+std::vector<std::string> CollectWorkloads(const std::vector<std::string> &paths);
+
+// calls work(i) for every i below count on a pool of threads (0: one per hardware
+// thread); the calling thread is one of the workers and returns once all are done
+void ForEachParallel(size_t count, unsigned threads, const std::function<void(size_t)> &work);
+
+// simulates every file with its own Scheduler set up from config on a shared
+// pool of worker threads; results come back in the order of the files
+std::vector<BatchResult> RunBatch(const SchedulerConfig &config, const std::vector<std::string> &files,
+                                  unsigned threads);
+
+// writes JSON when the name ends in .json, CSV otherwise; false on I/O errors
+bool WriteBatchResults(const std::string &outputFilename, const SchedulerConfig &config,
+                       const std::vector<BatchResult> &results);
+
+#endif
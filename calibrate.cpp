@@ -0,0 +1,115 @@
+#include "calibrate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static double Seconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+static double Median(std::vector<double> &samples)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+SwitchCosts CalibrateSwitchCosts(int samples)
+{
+    std::vector<double> forkSamples;
+    std::vector<double> waitSamples;
+    std::vector<double> stopSamples;
+    std::vector<double> resumeSamples;
+
+    std::cout.flush();
+
+    // fork / exit / waitpid of a child that does nothing
+    for (int i = 0; i < samples; i++)
+    {
+        std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            _exit(0);
+        }
+        if (pid == -1)
+        {
+            break;
+        }
+        std::chrono::steady_clock::time_point forked = std::chrono::steady_clock::now();
+
+        // wait until the child is a zombie without reaping it, then time the reaping alone
+        siginfo_t info;
+        waitid(P_PID, pid, &info, WEXITED | WNOWAIT);
+        std::chrono::steady_clock::time_point exited = std::chrono::steady_clock::now();
+        waitpid(pid, nullptr, 0);
+        std::chrono::steady_clock::time_point reaped = std::chrono::steady_clock::now();
+
+        forkSamples.push_back(Seconds(forked - before));
+        waitSamples.push_back(Seconds(reaped - exited));
+    }
+
+    // stop / continue round trips on one child waiting for signals
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        signal(SIGTSTP, SIG_DFL);
+        signal(SIGCONT, SIG_DFL);
+        for (;;)
+        {
+            pause();
+        }
+    }
+
+    if (pid > 0)
+    {
+        int status;
+        for (int i = 0; i < samples; i++)
+        {
+            std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+            kill(pid, SIGTSTP);
+            waitpid(pid, &status, WUNTRACED);
+            std::chrono::steady_clock::time_point stopped = std::chrono::steady_clock::now();
+            kill(pid, SIGCONT);
+            waitpid(pid, &status, WCONTINUED);
+            std::chrono::steady_clock::time_point resumed = std::chrono::steady_clock::now();
+
+            stopSamples.push_back(Seconds(stopped - before));
+            resumeSamples.push_back(Seconds(resumed - stopped));
+        }
+
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+    }
+
+    SwitchCosts costs;
+    costs.fork = Median(forkSamples);
+    costs.waitpid = Median(waitSamples);
+    costs.stop = Median(stopSamples);
+    costs.resume = Median(resumeSamples);
+    return costs;
+}
+
+double ContextSwitchCost(const SwitchCosts &costs)
+{
+    return costs.stop + costs.resume;
+}
+
+void PrintSwitchCosts(std::ostream &out, const SwitchCosts &costs)
+{
+    out << "Measured latencies (median):\n";
+    out << "  fork:     " << costs.fork * 1e6 << " microseconds\n";
+    out << "  waitpid:  " << costs.waitpid * 1e6 << " microseconds\n";
+    out << "  stop:     " << costs.stop * 1e6 << " microseconds\n";
+    out << "  continue: " << costs.resume * 1e6 << " microseconds\n";
+    out << "  context switch (stop + continue): " << ContextSwitchCost(costs) * 1e6 << " microseconds\n";
+}
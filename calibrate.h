@@ -0,0 +1,26 @@
+#ifndef CALIBRATE_H
+#define CALIBRATE_H
+
+#include <iostream>
+
+// ----------------------------------   CONTEXT SWITCH CALIBRATION   --------------------------------------
+
+// median latencies in seconds of the operations the fork executor performs per dispatch
+struct SwitchCosts
+{
+    double fork;               // fork() until it returns in the parent
+    double waitpid;            // reaping a child that has already exited
+    double stop;               // SIGTSTP until waitpid reports the child stopped
+    double resume;             // SIGCONT until waitpid reports the child continued
+};
+
+// measures the latencies on this host with throwaway children; call it before
+// the SIGCONT / SIGTSTP handlers of the fork executor are installed
+SwitchCosts CalibrateSwitchCosts(int samples);
+
+// cost of preempting one child and resuming another, the price of an RR dispatch
+double ContextSwitchCost(const SwitchCosts &costs);
+
+void PrintSwitchCosts(std::ostream &out, const SwitchCosts &costs);
+
+#endif
@@ -0,0 +1,263 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static const char kCheckpointMagic[8] = {'C', 'P', 'U', 'S', 'C', 'H', 'E', 'D'};
+
+// ----------------------------------   WRITER   --------------------------------------
+
+CheckpointWriter::CheckpointWriter()
+{
+    PutBytes(kCheckpointMagic, sizeof(kCheckpointMagic));
+    PutInt(kCheckpointVersion);
+}
+
+void CheckpointWriter::PutBytes(const void *bytes, size_t size)
+{
+    buffer.append(static_cast<const char *>(bytes), size);
+}
+
+void CheckpointWriter::PutInt(int64_t value)
+{
+    PutBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::PutDouble(double value)
+{
+    PutBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::PutString(const std::string &value)
+{
+    PutInt((int64_t)value.size());
+    PutBytes(value.data(), value.size());
+}
+
+void CheckpointWriter::PutProcess(const ProcessProfile &process)
+{
+    // the group index and the child are not saved, they belong to the scheduler that runs the process
+    PutString(process.name);
+    PutString(process.group);
+    PutInt(process.id);
+    PutDouble(process.burst_time);
+    PutInt(process.priority);
+    PutInt(process.deferrals);
+    PutDouble(process.remain_time);
+    PutDouble(process.turnaround_time);
+    PutDouble(process.total_waiting_time);
+    PutDouble(process.arrivalTime);
+    PutDouble(process.startTime);
+    PutDouble(process.endTime);
+    PutInt(process.status);
+    PutInt((int64_t)process.bursts.size());
+    for (double burst : process.bursts)
+    {
+        PutDouble(burst);
+    }
+    PutInt(process.burstIndex);
+    PutDouble(process.burstRemaining);
+    PutDouble(process.io_time);
+    PutDouble(process.readySince);
+    PutDouble(process.blockedSince);
+}
+
+void CheckpointWriter::PutConfig(const SchedulerConfig &config)
+{
+    PutString(config.policy);
+    PutDouble(config.quantum);
+    PutDouble(config.switchCost);
+    PutString(config.innerPolicy);
+    PutInt((int64_t)config.groupWeights.size());
+    for (const std::pair<std::string, double> &weight : config.groupWeights)
+    {
+        PutString(weight.first);
+        PutDouble(weight.second);
+    }
+    PutDouble(config.adaptivePercentile);
+    PutInt((int64_t)config.adaptiveWindow);
+    PutString(config.admission.action);
+    PutInt((int64_t)config.admission.maxReadyDepth);
+    PutDouble(config.admission.maxPredictedWait);
+    PutDouble(config.admission.deferDelay);
+    PutInt(config.admission.maxDeferrals);
+}
+
+bool CheckpointWriter::WriteFile(const std::string &filename) const
+{
+    std::string temporary = filename + ".tmp";
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+    {
+        return false;
+    }
+
+    output.write(buffer.data(), buffer.size());
+    output.close();
+    if (output.fail())
+    {
+        return false;
+    }
+
+    return std::rename(temporary.c_str(), filename.c_str()) == 0;
+}
+
+// ----------------------------------   READER   --------------------------------------
+
+CheckpointReader::CheckpointReader() : position(0), ok(false)
+{
+}
+
+bool CheckpointReader::ReadFile(const std::string &filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    if (!input.is_open())
+    {
+        return false;
+    }
+
+    buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    position = 0;
+    ok = true;
+
+    char magic[sizeof(kCheckpointMagic)];
+    if (!GetBytes(magic, sizeof(magic)) || memcmp(magic, kCheckpointMagic, sizeof(magic)) != 0)
+    {
+        ok = false;
+        return false;
+    }
+
+    // older or newer layouts are refused rather than misread
+    if (GetInt() != kCheckpointVersion)
+    {
+        ok = false;
+    }
+    return ok;
+}
+
+bool CheckpointReader::GetBytes(void *bytes, size_t size)
+{
+    if (!ok || buffer.size() - position < size)
+    {
+        ok = false;
+        memset(bytes, 0, size);
+        return false;
+    }
+
+    memcpy(bytes, buffer.data() + position, size);
+    position += size;
+    return true;
+}
+
+int64_t CheckpointReader::GetInt()
+{
+    int64_t value;
+    GetBytes(&value, sizeof(value));
+    return value;
+}
+
+double CheckpointReader::GetDouble()
+{
+    double value;
+    GetBytes(&value, sizeof(value));
+    return value;
+}
+
+std::string CheckpointReader::GetString()
+{
+    int64_t size = GetInt();
+    if (!ok || size < 0 || (uint64_t)size > buffer.size() - position)
+    {
+        ok = false;
+        return std::string();
+    }
+
+    std::string value = buffer.substr(position, size);
+    position += size;
+    return value;
+}
+
+ProcessProfile CheckpointReader::GetProcess()
+{
+    ProcessProfile process;
+    process.name = GetString();
+    process.group = GetString();
+    process.groupIndex = -1;
+    process.id = (int)GetInt();
+    process.burst_time = GetDouble();
+    process.priority = (int)GetInt();
+    process.deferrals = (int)GetInt();
+    process.pid = -1;
+    process.slot = -1;
+    process.remain_time = GetDouble();
+    process.turnaround_time = GetDouble();
+    process.total_waiting_time = GetDouble();
+    process.arrivalTime = GetDouble();
+    process.startTime = GetDouble();
+    process.endTime = GetDouble();
+    process.status = (ImplementationStatus)GetInt();
+
+    int64_t count = GetInt();
+    // every burst takes eight bytes, a larger count can only come from a corrupt file
+    if (count < 0 || (uint64_t)count > (buffer.size() - position) / sizeof(double))
+    {
+        ok = false;
+        count = 0;
+    }
+    for (int64_t i = 0; i < count; i++)
+    {
+        process.bursts.push_back(GetDouble());
+    }
+
+    process.burstIndex = (int)GetInt();
+    process.burstRemaining = GetDouble();
+    process.io_time = GetDouble();
+    process.readySince = GetDouble();
+    process.blockedSince = GetDouble();
+
+    if (process.burstIndex < 0 || process.burstIndex >= (int)process.bursts.size())
+    {
+        ok = false;
+    }
+    return process;
+}
+
+SchedulerConfig CheckpointReader::GetConfig()
+{
+    SchedulerConfig config;
+    config.policy = GetString();
+    config.quantum = GetDouble();
+    config.switchCost = GetDouble();
+    config.innerPolicy = GetString();
+
+    int64_t count = GetInt();
+    for (int64_t i = 0; ok && i < count; i++)
+    {
+        std::string group = GetString();
+        double weight = GetDouble();
+        config.groupWeights.push_back(std::make_pair(group, weight));
+    }
+
+    config.adaptivePercentile = GetDouble();
+    config.adaptiveWindow = (size_t)GetInt();
+    config.admission.action = GetString();
+    config.admission.maxReadyDepth = (size_t)GetInt();
+    config.admission.maxPredictedWait = GetDouble();
+    config.admission.deferDelay = GetDouble();
+    config.admission.maxDeferrals = (int)GetInt();
+    return config;
+}
+
+bool ReadCheckpointConfig(const std::string &filename, SchedulerConfig &config)
+{
+    CheckpointReader reader;
+    if (!reader.ReadFile(filename))
+    {
+        return false;
+    }
+
+    config = reader.GetConfig();
+    return reader.Ok();
+}
@@ -0,0 +1,70 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+
+#include "scheduler.h"
+
+// ----------------------------------   CHECKPOINT FILES   --------------------------------------
+//
+// A checkpoint is a magic string and a format version followed by the values
+// of the scheduler in a fixed order. Numbers are stored with their in-memory
+// representation, so doubles come back bit for bit; a checkpoint is only
+// read back on a host with the same byte order.
+
+// 2: admission control, pending arrivals and deferrals
+// 3: the turnaround histogram replaces the list of admitted turnarounds
+// 4: the shortest and longest turnaround that bound the histogram percentiles
+static const uint32_t kCheckpointVersion = 4;
+
+class CheckpointWriter
+{
+public:
+    CheckpointWriter();
+
+    void PutInt(int64_t value);
+    void PutDouble(double value);
+    void PutString(const std::string &value);
+    void PutProcess(const ProcessProfile &process);
+    void PutConfig(const SchedulerConfig &config);
+
+    // writes a temporary file and renames it over the old checkpoint, so an
+    // interrupted write never leaves a broken one behind; false on I/O errors
+    bool WriteFile(const std::string &filename) const;
+
+private:
+    void PutBytes(const void *bytes, size_t size);
+
+    std::string buffer;
+};
+
+class CheckpointReader
+{
+public:
+    CheckpointReader();
+
+    // false when the file can not be read or is not a checkpoint of this version
+    bool ReadFile(const std::string &filename);
+
+    // past the end of the file these return zeros and Ok() turns false
+    int64_t GetInt();
+    double GetDouble();
+    std::string GetString();
+    ProcessProfile GetProcess();
+    SchedulerConfig GetConfig();
+
+    bool Ok() const { return ok; }
+
+private:
+    bool GetBytes(void *bytes, size_t size);
+
+    std::string buffer;
+    size_t position;
+    bool ok;
+};
+
+// the settings saved at the start of a checkpoint, false when it can not be read
+bool ReadCheckpointConfig(const std::string &filename, SchedulerConfig &config);
+
+#endif
@@ -0,0 +1,169 @@
+#include "coroutine_executor.h"
+
+#include <coroutine>
+#include <exception>
+
+// what is left of a slice below this is a rounding leftover of fractional slices
+static const double kBudgetEpsilon = 1e-9;
+
+// ----------------------------------   PROCESS COROUTINE   --------------------------------------
+
+// the promise is the coroutine's side of its PCB: the executor writes the budget
+// of a slice before resuming, the coroutine reports the CPU time it consumed
+struct ProcessPromise;
+using ProcessHandle = std::coroutine_handle<ProcessPromise>;
+
+struct ProcessTask
+{
+    using promise_type = ProcessPromise;
+    ProcessHandle handle;
+};
+
+struct ProcessPromise
+{
+    double budget = 0;         // CPU time the current slice still grants
+    double executed = 0;       // CPU time consumed over the whole life
+
+    ProcessTask get_return_object() { return ProcessTask{ProcessHandle::from_promise(*this)}; }
+    // created stopped, like a preforked child, and kept after the end so done() can be checked
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+};
+
+// hands the body its own promise without suspending
+struct PromiseOf
+{
+    ProcessPromise *promise = nullptr;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(ProcessHandle handle) noexcept
+    {
+        promise = &handle.promise();
+        return false;
+    }
+    ProcessPromise &await_resume() const noexcept { return *promise; }
+};
+
+// suspends the coroutine whenever its slice is used up
+struct SliceEnd
+{
+    ProcessPromise &promise;
+
+    bool await_ready() const noexcept { return promise.budget > kBudgetEpsilon; }
+    void await_suspend(ProcessHandle) const noexcept {}
+    void await_resume() const noexcept {}
+};
+
+// the body of a simulated process: it runs its CPU time in pieces of at most one
+// slice and yields at every slice boundary, I/O happens while it is suspended
+static ProcessTask ProcessBody(double cpuTime)
+{
+    ProcessPromise &promise = co_await PromiseOf{};
+    double remaining = cpuTime;
+
+    while (remaining > kBudgetEpsilon)
+    {
+        co_await SliceEnd{promise};
+
+        double run = promise.budget < remaining ? promise.budget : remaining;
+        remaining -= run;
+        promise.budget -= run;
+        promise.executed += run;
+    }
+}
+
+// ----------------------------------   EXECUTOR   --------------------------------------
+
+CoroutineExecutor::CoroutineExecutor() : resumes(0), live(0)
+{
+}
+
+CoroutineExecutor::~CoroutineExecutor()
+{
+    // processes still queued when the scheduler is abandoned
+    for (void *frame : frames)
+    {
+        if (frame != nullptr)
+        {
+            ProcessHandle::from_address(frame).destroy();
+        }
+    }
+}
+
+bool CoroutineExecutor::Admit(ProcessProfile &process)
+{
+    int slot;
+    if (freeSlots.empty())
+    {
+        slot = (int)frames.size();
+        frames.push_back(nullptr);
+    }
+    else
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+
+    // the body only starts running at the first dispatch
+    ProcessTask task = ProcessBody(process.burst_time);
+    frames[slot] = task.handle.address();
+    process.slot = slot;
+    live++;
+    return true;
+}
+
+// destroys the coroutine of the process and frees its slot
+void CoroutineExecutor::Release(ProcessProfile &process)
+{
+    ProcessHandle::from_address(frames[process.slot]).destroy();
+    frames[process.slot] = nullptr;
+    freeSlots.push_back(process.slot);
+    process.slot = -1;
+    live--;
+}
+
+bool CoroutineExecutor::Dispatch(ProcessProfile &process, double slice)
+{
+    // the scheduler then fails the process, an embedding program keeps running
+    if (process.slot < 0 || (size_t)process.slot >= frames.size() || frames[process.slot] == nullptr)
+    {
+        std::cerr << "Dispatch of process " << process.name << " that has no coroutine." << std::endl;
+        return false;
+    }
+
+    ProcessHandle handle = ProcessHandle::from_address(frames[process.slot]);
+    if (handle.done())
+    {
+        std::cerr << "Dispatch of process " << process.name << " that has already finished." << std::endl;
+        Release(process);
+        return false;
+    }
+
+    handle.promise().budget = slice;
+    handle.resume();
+    resumes++;
+    return true;
+}
+
+bool CoroutineExecutor::Complete(ProcessProfile &process)
+{
+    if (process.slot < 0 || (size_t)process.slot >= frames.size() || frames[process.slot] == nullptr)
+    {
+        std::cerr << "Completion of process " << process.name << " that has no coroutine." << std::endl;
+        return false;
+    }
+
+    // the scheduler and the coroutine must agree that the process ran all of its CPU time
+    ProcessHandle handle = ProcessHandle::from_address(frames[process.slot]);
+    bool done = handle.done();
+    if (!done)
+    {
+        std::cerr << "Process " << process.name << " completed after " << handle.promise().executed
+                  << " of " << process.burst_time << " seconds." << std::endl;
+    }
+
+    Release(process);
+    return done;
+}
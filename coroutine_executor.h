@@ -0,0 +1,41 @@
+#ifndef COROUTINE_EXECUTOR_H
+#define COROUTINE_EXECUTOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "scheduler.h"
+
+// runs every process as a C++20 coroutine inside this process: a dispatch
+// resumes the coroutine with a budget of CPU time and the coroutine suspends
+// itself once the budget is used up, so a context switch is a resume and a
+// suspend instead of a fork and a pair of signals. Only this translation unit's
+// implementation needs C++20, the header stays usable from C++17 code.
+class CoroutineExecutor : public Executor
+{
+public:
+    CoroutineExecutor();
+    ~CoroutineExecutor();
+
+    CoroutineExecutor(const CoroutineExecutor &) = delete;
+    CoroutineExecutor &operator=(const CoroutineExecutor &) = delete;
+
+    bool Dispatch(ProcessProfile &process, double slice) override;
+    bool Complete(ProcessProfile &process) override;
+    bool Admit(ProcessProfile &process) override;
+
+    // coroutines resumed so far and coroutines currently alive
+    long Resumes() const { return resumes; }
+    size_t Live() const { return live; }
+
+private:
+    void Release(ProcessProfile &process);
+
+    // frame addresses of the coroutines by the slot of their process, nullptr when free
+    std::vector<void *> frames;
+    std::vector<int> freeSlots;
+    long resumes;
+    size_t live;
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include "daemon.h"
+
+#include <cerrno>
+#include <chrono>
+#include <set>
+#include <signal.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "unix_socket.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void DaemonStopHandler(int signum)
+{
+    stopRequested = 1;
+}
+
+DaemonOptions DefaultDaemonOptions()
+{
+    DaemonOptions options;
+    options.queueLimit = 1024;
+    options.batchSize = 64;
+    return options;
+}
+
+// ----------------------------------   INGESTOR   --------------------------------------
+
+JobIngestor::JobIngestor(size_t capacity) : capacity(capacity > 0 ? capacity : 1), closed(false)
+{
+}
+
+bool JobIngestor::Push(const ProcessProfile &process)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this] { return closed || pending.size() < capacity; });
+    if (closed)
+    {
+        return false;
+    }
+
+    pending.push_back(process);
+    notEmpty.notify_one();
+    return true;
+}
+
+void JobIngestor::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+    notFull.notify_all();
+}
+
+size_t JobIngestor::DrainInto(Scheduler &scheduler, size_t maxBatch, double arrivalTime)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t moved = 0;
+    while (!pending.empty() && moved < maxBatch)
+    {
+        ProcessProfile &process = pending.front();
+        process.arrivalTime = arrivalTime;
+        scheduler.Submit(process);
+        pending.pop_front();
+        moved++;
+    }
+
+    if (moved > 0)
+    {
+        notFull.notify_all();
+    }
+    return moved;
+}
+
+bool JobIngestor::WaitForJobs()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [this] { return closed || !pending.empty(); });
+    return !pending.empty();
+}
+
+// ----------------------------------   READERS   --------------------------------------
+
+// feeds one line of input to the ingestor, false when the ingestor is closed
+static bool SubmitLine(JobIngestor &ingestor, const std::string &line, int replyFd)
+{
+    if (line.empty())
+    {
+        return true;
+    }
+
+    ProcessProfile process;
+    if (!ParseProcessLine(line, process))
+    {
+        std::string reply = "error: malformed submission: " + line + "\n";
+        if (replyFd >= 0)
+        {
+            // MSG_NOSIGNAL: a client that went away must not kill the daemon with SIGPIPE
+            send(replyFd, reply.c_str(), reply.size(), MSG_NOSIGNAL);
+        }
+        else
+        {
+            std::cerr << reply;
+        }
+        return true;
+    }
+
+    return ingestor.Push(process);
+}
+
+static void ReadStdin(JobIngestor &ingestor)
+{
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (!SubmitLine(ingestor, line, -1))
+        {
+            break;
+        }
+    }
+
+    ingestor.Close();
+}
+
+// connections whose reader thread is still running; each reader closes its own when it is done
+struct ClientConnections
+{
+    std::mutex mutex;
+    std::condition_variable closed;
+    std::set<int> fds;
+};
+
+static void ReadClient(JobIngestor &ingestor, ClientConnections &connections, int clientFd)
+{
+    char buffer[4096];
+    std::string partial;
+    bool open = true;
+
+    while (open)
+    {
+        ssize_t received = read(clientFd, buffer, sizeof(buffer));
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            break;
+        }
+
+        // a single read usually carries a whole batch of submissions
+        partial.append(buffer, received);
+        size_t begin = 0;
+        size_t end;
+        while (open && (end = partial.find('\n', begin)) != std::string::npos)
+        {
+            open = SubmitLine(ingestor, partial.substr(begin, end - begin), clientFd);
+            begin = end + 1;
+        }
+        partial.erase(0, begin);
+    }
+
+    if (open && !partial.empty())
+    {
+        SubmitLine(ingestor, partial, clientFd);
+    }
+
+    std::lock_guard<std::mutex> lock(connections.mutex);
+    connections.fds.erase(clientFd);
+    close(clientFd);
+    connections.closed.notify_all();
+}
+
+// accepts clients until a stop is requested, then closes the ingestor; every client
+// gets a detached reader thread, so finished ones hold neither a descriptor nor a thread
+static void AcceptClients(JobIngestor &ingestor, int listenFd)
+{
+    ClientConnections connections;
+
+    auto KeepRunning = []() { return !stopRequested; };
+    AcceptConnections(listenFd, KeepRunning, [&ingestor, &connections](int clientFd)
+    {
+        std::lock_guard<std::mutex> lock(connections.mutex);
+        connections.fds.insert(clientFd);
+        std::thread(ReadClient, std::ref(ingestor), std::ref(connections), clientFd).detach();
+    });
+
+    // unblock readers stuck in Push() or read() and wait until all of them are gone
+    ingestor.Close();
+    std::unique_lock<std::mutex> lock(connections.mutex);
+    for (int clientFd : connections.fds)
+    {
+        shutdown(clientFd, SHUT_RDWR);
+    }
+    connections.closed.wait(lock, [&connections] { return connections.fds.empty(); });
+}
+
+// ----------------------------------   SCHEDULING LOOP   --------------------------------------
+
+int RunDaemon(Scheduler &scheduler, const DaemonOptions &options)
+{
+    JobIngestor ingestor(options.queueLimit);
+    std::thread reader;
+    int listenFd = -1;
+
+    if (options.socketPath.empty())
+    {
+        reader = std::thread(ReadStdin, std::ref(ingestor));
+    }
+    else
+    {
+        listenFd = OpenListeningSocket(options.socketPath);
+        if (listenFd == -1)
+        {
+            return 1;
+        }
+
+        struct sigaction stopAction;
+        sigemptyset(&stopAction.sa_mask);
+        stopAction.sa_handler = DaemonStopHandler;
+        stopAction.sa_flags = 0;
+        sigaction(SIGINT, &stopAction, nullptr);
+        sigaction(SIGTERM, &stopAction, nullptr);
+
+        std::cout << "Listening for submissions on " << options.socketPath << std::endl;
+        reader = std::thread(AcceptClients, std::ref(ingestor), listenFd);
+    }
+
+    scheduler.SetCompletionCallback([](const ProcessProfile &process)
+    {
+        if (process.status == ImplementationStatus::FAILED)
+        {
+            std::cout << "failed " << process.name << " end=" << process.endTime << "\n";
+            return;
+        }
+        std::cout << "done " << process.name
+                  << " arrival=" << process.arrivalTime
+                  << " end=" << process.endTime
+                  << " turnaround=" << process.turnaround_time
+                  << " waiting=" << process.total_waiting_time << "\n";
+    });
+
+    // arrivals are stamped with the wall clock; the scheduler clock is kept at least
+    // that far, so a backlog shows up as waiting time of the new arrivals
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    auto Now = [&started]()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    };
+
+    while (true)
+    {
+        double now = Now();
+        scheduler.AdvanceClock(now);
+        ingestor.DrainInto(scheduler, options.batchSize, now);
+
+        if (scheduler.Step())
+        {
+            continue;
+        }
+
+        std::cout << std::flush;
+        if (!ingestor.WaitForJobs())
+        {
+            break;
+        }
+    }
+
+    reader.join();
+    if (listenFd != -1)
+    {
+        close(listenFd);
+        unlink(options.socketPath.c_str());
+    }
+
+    PrintReport(std::cout, scheduler);
+    return 0;
+}
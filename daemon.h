@@ -0,0 +1,53 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "scheduler.h"
+
+// ----------------------------------   ONLINE (DAEMON) MODE   --------------------------------------
+
+struct DaemonOptions
+{
+    std::string socketPath;    // empty: read submissions from stdin
+    size_t queueLimit;         // submissions buffered before the readers block
+    size_t batchSize;          // submissions moved into the ready queue per dispatch
+};
+
+DaemonOptions DefaultDaemonOptions();
+
+// bounded hand-off between the reader threads and the scheduling loop; a full
+// buffer blocks the readers, which in turn stops them from draining their pipe
+// or socket, so submitters feel the backpressure instead of the dispatcher
+class JobIngestor
+{
+public:
+    explicit JobIngestor(size_t capacity);
+
+    // blocks while the buffer is full; false once the ingestor is closed
+    bool Push(const ProcessProfile &process);
+    // no more submissions will come, lets the scheduling loop finish
+    void Close();
+
+    // moves up to maxBatch submissions under a single lock, stamping them with the arrival time
+    size_t DrainInto(Scheduler &scheduler, size_t maxBatch, double arrivalTime);
+    // sleeps until there is something to drain; false when closed and empty
+    bool WaitForJobs();
+
+private:
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<ProcessProfile> pending;
+    size_t capacity;
+    bool closed;
+};
+
+// runs the scheduler until the input is exhausted (stdin) or SIGINT/SIGTERM
+// arrives (socket), printing one "done" or "failed" line per process that leaves
+int RunDaemon(Scheduler &scheduler, const DaemonOptions &options);
+
+#endif
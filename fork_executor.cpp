@@ -0,0 +1,446 @@
+#include "fork_executor.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// the handlers of the parent have no context argument, so they look the
+// running child up through the executor registered in InstallSignalHandlers
+static ForkExecutor *activeExecutor = nullptr;
+
+static pid_t CurrentPID()
+{
+    if (activeExecutor == nullptr || activeExecutor->Current() == nullptr)
+    {
+        return -1;
+    }
+
+    return activeExecutor->Current()->pid;
+}
+
+// ----------------------------------   SIGNAL HANDLERS   --------------------------------------
+
+static void ContinueHandler(int signum)
+{
+    pid_t currentPID = CurrentPID();
+
+    if (currentPID > 0)
+    {
+        std::cout << "Continue Handler called." << std::endl << std::flush;
+        if (kill(currentPID, SIGCONT) == 0)
+        {
+            activeExecutor->Current()->status = ImplementationStatus::RUNNING;
+        }
+        else
+        {
+            std::cerr << "Error resuming process with PID " << currentPID << ". Errno: " << errno << std::endl << std::flush;
+        }
+    }
+}
+
+static void StopHandler(int signum)
+{
+    pid_t currentPID = CurrentPID();
+
+    if (currentPID > 0)
+    {
+        std::cout << "Stop Handler called." << std::endl << std::flush;
+        if (kill(currentPID, SIGTSTP) == 0)
+        {
+            activeExecutor->Current()->status = ImplementationStatus::STOPPED;
+        }
+        else
+        {
+            std::cerr << "Error stopping process with PID " << currentPID << ". Errno: " << errno << std::endl << std::flush;
+        }
+    }
+}
+
+bool InstallSignalHandlers(ForkExecutor *executor)
+{
+    activeExecutor = executor;
+
+    // completions are read from the shared PCB table, SIGCHLD keeps its default action
+    // Set up signal handler for SIGCONT (ContinueHandler)
+    struct sigaction continueAction;
+    sigemptyset(&continueAction.sa_mask);
+    continueAction.sa_handler = ContinueHandler;
+    continueAction.sa_flags = 0;
+    if (sigaction(SIGCONT, &continueAction, nullptr) == -1)
+    {
+        perror("Error setting up signal ContinueHandler");
+        return false;
+    }
+
+    struct sigaction stopAction;
+    sigemptyset(&stopAction.sa_mask);
+    stopAction.sa_handler = StopHandler;
+    stopAction.sa_flags = 0;
+    if (sigaction(SIGTSTP, &stopAction, nullptr) == -1)
+    {
+        perror("Error setting up signal StopHandler");
+        return false;
+    }
+
+    return true;
+}
+
+static bool RaiseLimit(int resource, rlim_t needed, const char *name, std::ostream &out)
+{
+    struct rlimit limit;
+    if (getrlimit(resource, &limit) == -1)
+    {
+        return false;
+    }
+
+    if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(resource, &limit);
+    }
+
+    if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < needed)
+    {
+        out << "Warning: " << name << " is " << limit.rlim_cur << ", below the " << needed << " needed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool RaiseProcessLimits(size_t children, std::ostream &out)
+{
+    // the children count against RLIMIT_NPROC of the user together with the
+    // processes already running, so keep some headroom
+    bool processes = RaiseLimit(RLIMIT_NPROC, children + 64, "RLIMIT_NPROC", out);
+    // descriptors are not needed per child, only the socket clients of the daemon use more of them
+    bool files = RaiseLimit(RLIMIT_NOFILE, 0, "RLIMIT_NOFILE", out);
+    return processes && files;
+}
+
+// ----------------------------------   CHILD / PARENT HELPERS   --------------------------------------
+
+static pid_t ForkChild(const ProcessProfile &currentProcess)
+{
+    // anything still buffered would otherwise be printed twice, once by the child
+    std::cout.flush();
+    std::cerr.flush();
+
+    pid_t pid = fork();
+
+    // e.g. EAGAIN under RLIMIT_NPROC, only this process fails
+    if (pid == -1)
+    {
+        std::cerr << "Fork failed for process " << currentProcess.name << ". Errno: " << errno << std::endl;
+    }
+
+    // 0 in the child, the child's pid in the parent, -1 on errors
+    return pid;
+}
+
+// the child works in ticks of this length, time spent stopped between ticks is not counted
+static const long kTickNanoseconds = 10 * 1000 * 1000;
+static const double kTicksPerSecond = 1e9 / kTickNanoseconds;
+
+// the parent checks the table this often while a slice runs
+static const long kPollNanoseconds = 1000 * 1000;
+static const int kPollsPerLivenessCheck = 1000;
+
+static long TicksFor(double seconds)
+{
+    return (long)(seconds * kTicksPerSecond + 0.5);
+}
+
+// the child sleeps through its CPU time one tick at a time, so time spent
+// stopped by the parent is not counted as execution; every tick is published
+// in its entry of the shared table
+static void ChildExecutionSimulation(const ProcessProfile &currentProcess, SharedProcessState &entry, bool startStopped)
+{
+    // the handlers of the parent must not run in the child, otherwise SIGTSTP could not stop it
+    signal(SIGCONT, SIG_DFL);
+    signal(SIGTSTP, SIG_DFL);
+
+    if (startStopped)
+    {
+        raise(SIGTSTP);
+    }
+
+    entry.status.store(ImplementationStatus::RUNNING, std::memory_order_release);
+
+    long ticks = TicksFor(currentProcess.remain_time);
+    struct timespec tick = {0, kTickNanoseconds};
+    long done = 0;
+    while (done < ticks)
+    {
+        struct timespec before;
+        struct timespec after;
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        nanosleep(&tick, nullptr);
+        clock_gettime(CLOCK_MONOTONIC, &after);
+        entry.heartbeat.fetch_add(1, std::memory_order_relaxed);
+
+        // a tick that spans a stop by the parent returns late and is not counted,
+        // otherwise every resume would hand out a tick for free
+        long elapsed = (after.tv_sec - before.tv_sec) * 1000000000L + (after.tv_nsec - before.tv_nsec);
+        if (elapsed < 2 * kTickNanoseconds)
+        {
+            done++;
+            entry.progressTicks.store(done, std::memory_order_release);
+        }
+    }
+
+    entry.status.store(ImplementationStatus::EXITED, std::memory_order_release);
+    _exit(0);
+}
+
+static void SleepFully(double seconds)
+{
+    if (seconds <= 0)
+    {
+        return;
+    }
+
+    struct timespec remaining;
+    remaining.tv_sec = (time_t)seconds;
+    remaining.tv_nsec = (long)((seconds - remaining.tv_sec) * 1e9);
+
+    // nanosleep() returns early when a SIGCONT or SIGTSTP handler runs
+    while (nanosleep(&remaining, &remaining) == -1 && errno == EINTR)
+    {
+    }
+}
+
+static void ParentWaitChld(std::ostream *log, const ProcessProfile &currentProcess)
+{
+    int status = 0;
+
+    pid_t result;
+    do
+    {
+        result = waitpid(currentProcess.pid, &status, 0);
+    } while (result == -1 && errno == EINTR);
+
+    if (result == -1)
+    {
+        std::cerr << "Error waiting for process with PID " << currentProcess.pid << ". Errno: " << errno << std::endl;
+        return;
+    }
+
+    if (log == nullptr)
+    {
+        return;
+    }
+
+    if (WIFEXITED(status))
+    {
+        *log << "Child exited with status of " << WEXITSTATUS(status) << ".\n\n";
+    }
+    else if (WIFSIGNALED(status))
+    {
+        *log << "Child was interrupt by signal " << WTERMSIG(status) << ".\n\n";
+    }
+    else
+    {
+        *log << "Reason unknown for child termination.\n";
+    }
+}
+
+// ----------------------------------   EXECUTOR   --------------------------------------
+
+ForkExecutor::ForkExecutor(size_t tableCapacity) : log(nullptr), prefork(false), current(nullptr), table(tableCapacity)
+{
+}
+
+ForkExecutor::~ForkExecutor()
+{
+    if (activeExecutor == this)
+    {
+        activeExecutor = nullptr;
+    }
+}
+
+// forks the child of the process; a stopped child waits for its first SIGCONT.
+// false when the table is full or fork() failed, the process then can not run
+bool ForkExecutor::StartChild(ProcessProfile &process, bool stopped)
+{
+    process.slot = table.Acquire();
+    if (process.slot == -1)
+    {
+        std::cerr << "Shared process table is full, can not start process " << process.name << std::endl;
+        return false;
+    }
+    SharedProcessState &entry = table.Entry(process.slot);
+
+    pid_t pid = ForkChild(process);
+    if (pid == -1)
+    {
+        table.Release(process.slot);
+        process.slot = -1;
+        return false;
+    }
+    if (pid == 0)
+    {
+        ChildExecutionSimulation(process, entry, stopped);
+    }
+
+    process.pid = pid;
+    entry.pid.store(pid, std::memory_order_relaxed);
+
+    if (stopped)
+    {
+        // a SIGCONT sent before the child stopped itself would be lost, so wait for the stop
+        int status;
+        while (waitpid(pid, &status, WUNTRACED) == -1 && errno == EINTR)
+        {
+        }
+        entry.status.store(ImplementationStatus::STOPPED, std::memory_order_relaxed);
+    }
+
+    if (log != nullptr)
+    {
+        *log << "Parent process has forked a child process with PID " << pid << std::endl;
+    }
+    return true;
+}
+
+bool ForkExecutor::Admit(ProcessProfile &process)
+{
+    if (prefork && process.pid == -1)
+    {
+        return StartChild(process, true);
+    }
+    return true;
+}
+
+// the child died without finishing: it is marked EXITED in the table, reaped and its entry freed
+void ForkExecutor::Bury(ProcessProfile &process)
+{
+    table.Entry(process.slot).status.store(ImplementationStatus::EXITED, std::memory_order_relaxed);
+    ParentWaitChld(log, process);
+    table.Release(process.slot);
+    process.slot = -1;
+    process.status = ImplementationStatus::EXITED;
+    current = nullptr;
+}
+
+bool ForkExecutor::Dispatch(ProcessProfile &process, double slice)
+{
+    if (process.pid == -1)
+    {
+        if (!StartChild(process, false))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        table.Entry(process.slot).status.store(ImplementationStatus::RUNNING, std::memory_order_relaxed);
+        if (kill(process.pid, SIGCONT) == 0 && log != nullptr)
+        {
+            *log << "Resumed process with PID " << process.pid << std::endl;
+        }
+    }
+
+    current = &process;
+
+    // the last slice runs to the end of the child, Complete() waits for it
+    if (process.remain_time - slice > 1e-9)
+    {
+        // the slice ends when the child has reported enough CPU time, not after a wall clock guess
+        if (!WaitForProgress(process, TicksFor(process.burst_time - process.remain_time + slice)))
+        {
+            Bury(process);
+            return false;
+        }
+
+        kill(process.pid, SIGTSTP);
+        table.Entry(process.slot).status.store(ImplementationStatus::STOPPED, std::memory_order_relaxed);
+        process.status = ImplementationStatus::STOPPED;
+        if (log != nullptr)
+        {
+            *log << "Process with PID " << process.pid << " has been stopped after " << slice << " seconds." << std::endl;
+        }
+        current = nullptr;
+    }
+    return true;
+}
+
+bool ForkExecutor::Complete(ProcessProfile &process)
+{
+    if (log != nullptr)
+    {
+        *log << "Parent process waits for child process with PID " << process.pid << " to finish..." << std::endl;
+    }
+
+    // the table tells when the child is done, waitpid only reaps it
+    if (!WaitForProgress(process, TicksFor(process.burst_time)))
+    {
+        Bury(process);
+        return false;
+    }
+    ParentWaitChld(log, process);
+
+    if (log != nullptr)
+    {
+        *log << "Process with PID " << process.pid << " has terminated after "
+             << Progress(process) << " seconds of CPU time.\n";
+    }
+
+    table.Release(process.slot);
+    process.slot = -1;
+    current = nullptr;
+    return true;
+}
+
+double ForkExecutor::Progress(const ProcessProfile &process)
+{
+    if (process.slot == -1)
+    {
+        return 0;
+    }
+
+    return table.Entry(process.slot).progressTicks.load(std::memory_order_acquire) / kTicksPerSecond;
+}
+
+// polls the entry of the child until it has executed targetTicks or exited;
+// false when the child died without reporting
+bool ForkExecutor::WaitForProgress(const ProcessProfile &process, long targetTicks)
+{
+    SharedProcessState &entry = table.Entry(process.slot);
+    struct timespec poll = {0, kPollNanoseconds};
+    long lastHeartbeat = -1;
+    int polls = 0;
+
+    while (entry.progressTicks.load(std::memory_order_acquire) < targetTicks &&
+           entry.status.load(std::memory_order_acquire) != ImplementationStatus::EXITED)
+    {
+        nanosleep(&poll, nullptr);
+
+        // a heartbeat that stops moving for a while means the child may be gone
+        if (++polls % kPollsPerLivenessCheck == 0)
+        {
+            long heartbeat = entry.heartbeat.load(std::memory_order_relaxed);
+            siginfo_t info;
+            info.si_pid = 0;
+            if (heartbeat == lastHeartbeat &&
+                waitid(P_PID, process.pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid != 0)
+            {
+                std::cerr << "Process with PID " << process.pid << " died without reporting completion." << std::endl;
+                return false;
+            }
+            lastHeartbeat = heartbeat;
+        }
+    }
+
+    return true;
+}
+
+void ForkExecutor::Idle(double duration)
+{
+    // every child is stopped while the device works, keep the real timeline in step
+    SleepFully(duration);
+}
@@ -0,0 +1,59 @@
+#ifndef FORK_EXECUTOR_H
+#define FORK_EXECUTOR_H
+
+#include <iostream>
+
+#include "scheduler.h"
+#include "pcb_table.h"
+
+// runs every process as a forked child that sleeps through its burst, and
+// controls it with SIGTSTP / SIGCONT between slices; the children publish
+// their progress in a shared PCB table, which is how the parent times the
+// slices and notices completions
+class ForkExecutor : public Executor
+{
+public:
+    // at most tableCapacity children can be alive at the same time
+    explicit ForkExecutor(size_t tableCapacity = 65536);
+    ~ForkExecutor();
+
+    bool Dispatch(ProcessProfile &process, double slice) override;
+    bool Complete(ProcessProfile &process) override;
+    void Idle(double duration) override;
+    bool Admit(ProcessProfile &process) override;
+
+    // false when the shared PCB table could not be mapped, the executor can not start any child
+    bool Valid() const { return table.Valid(); }
+
+    void SetLog(std::ostream *log) { this->log = log; }
+    // fork every child as soon as it is admitted and keep it stopped until its
+    // first dispatch, instead of forking at the first dispatch
+    void SetPrefork(bool prefork) { this->prefork = prefork; }
+
+    // process currently holding the CPU, read by the signal handlers
+    ProcessProfile *Current() const { return current; }
+
+    // CPU time the child has reported so far, read from the shared table
+    double Progress(const ProcessProfile &process);
+
+private:
+    bool WaitForProgress(const ProcessProfile &process, long targetTicks);
+    void Bury(ProcessProfile &process);
+    bool StartChild(ProcessProfile &process, bool stopped);
+
+    std::ostream *log;
+    bool prefork;
+    ProcessProfile *current;
+    SharedProcessTable table;
+};
+
+// installs the SIGCONT / SIGTSTP handlers of the parent, which forward job
+// control to the running child of the executor given here, so only one can be
+// active per process
+bool InstallSignalHandlers(ForkExecutor *executor);
+
+// raises the soft RLIMIT_NPROC / RLIMIT_NOFILE limits to their hard limits and
+// warns on the given stream when that is still not enough for the children
+bool RaiseProcessLimits(size_t children, std::ostream &out);
+
+#endif
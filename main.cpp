@@ -0,0 +1,702 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "scheduler.h"
+#include "fork_executor.h"
+#include "daemon.h"
+#include "batch.h"
+#include "calibrate.h"
+#include "checkpoint.h"
+#include "coroutine_executor.h"
+#include "metrics.h"
+#include "tune.h"
+
+using namespace std;
+
+// ----------------------------------   COMMAND LINE DRIVER   --------------------------------------
+
+static const int kCalibrationSamples = 200;
+static const size_t kDefaultMaxChildren = 65536;
+static const size_t kDefaultQuantumWindow = 64;
+static const int kTuneCandidates = 32;
+static const int kDefaultCheckpointEvery = 100000;
+
+struct CliOptions
+{
+    std::string policy;
+    std::string inputFilename;
+    double quantum;            // seconds
+    std::string innerPolicy;   // FAIR: policy inside each group
+    std::string weights;       // FAIR: "GROUP=WEIGHT,..."
+    bool simulate;             // virtual clock only, no child processes
+    bool coroutines;           // every process is a coroutine of this process instead of a child
+    bool daemon;               // keep accepting submissions while scheduling
+    DaemonOptions daemonOptions;
+    bool batch;                // simulate many input files in one run
+    std::vector<std::string> batchInputs;
+    std::string outputFilename;
+    unsigned threads;
+    bool calibrate;            // only measure the switching latencies of this host
+    std::string switchCost;    // milliseconds, or "measured"
+    bool prefork;              // start every child stopped before scheduling begins
+    bool quiet;                // no per process reports
+    size_t maxChildren;        // 0: sized from the input file
+    std::string metricsSocket; // serve live metrics here while scheduling
+    double adaptivePercentile; // 0: fixed quantum
+    size_t quantumWindow;
+    std::string tune;          // search the quantum for "mean" or "p99" turnaround instead of running
+    std::string checkpoint;    // save the state here while running
+    int checkpointEvery;       // dispatches between two checkpoints
+    std::string resume;        // continue from this checkpoint
+    AdmissionControl admission;
+};
+
+static void PrintUsage()
+{
+    std::cout << "Usage: cpu_scheduler [--simulate|--coroutines] <POLICY> [QUANTUM] <INPUT_FILE>\n"
+              << "       cpu_scheduler --daemon [--socket PATH] [--queue-limit N] [--batch-size N]\n"
+              << "                     [--simulate] <POLICY> [QUANTUM] [INPUT_FILE]\n"
+              << "       cpu_scheduler --batch --output RESULTS.csv|RESULTS.json [--threads N]\n"
+              << "                     <POLICY> [QUANTUM] <INPUT_FILE|DIRECTORY>...\n"
+              << "       cpu_scheduler --tune mean|p99 [--threads N] <POLICY> <INPUT_FILE>\n"
+              << "       cpu_scheduler --simulate --resume CHECKPOINT [<POLICY> [QUANTUM]]\n"
+              << "       cpu_scheduler --calibrate\n"
+              << "\n"
+              << "FAIR accepts --inner RR|SJF|PRIO and --weights GROUP=WEIGHT,...\n"
+              << "Real runs also accept --prefork, --quiet and --max-children N.\n"
+              << "Simulated runs accept --checkpoint FILE [--checkpoint-every N].\n"
+              << "Any mode but --batch accepts --metrics-socket PATH.\n"
+              << "Admission control: --admission reject|defer|deprioritize with --max-ready N and / or --max-wait MS,\n"
+              << "                   --defer-delay MS and --max-deferrals N for defer.\n"
+              << "Policies with a quantum accept --adaptive-quantum PERCENTILE [--quantum-window N].\n"
+              << "Any mode accepts --switch-cost MILLISECONDS|measured before the policy.\n";
+}
+
+// *************************  parse the arguments from the command line  ********************************
+
+// reads the whole value of an option as a number, trailing garbage is an error as in the group weights
+template <typename T>
+static bool ParseNumber(const std::string &option, const std::string &text, T &value)
+{
+    std::istringstream stream(text);
+    if (!(stream >> value) || !stream.eof())
+    {
+        std::cout << "Wrong Format! " << option << " takes a number, not " << text << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// the same for counts, which an unsigned read would silently wrap when negative
+template <typename T>
+static bool ParseCount(const std::string &option, const std::string &text, T &value)
+{
+    long long count;
+    if (!ParseNumber(option, text, count))
+    {
+        return false;
+    }
+    if (count < 0)
+    {
+        std::cout << "Wrong Format! " << option << " can not be negative." << std::endl;
+        return false;
+    }
+    value = static_cast<T>(count);
+    return true;
+}
+
+bool ParseArguments(int argc, char *argv[], CliOptions &options)
+{
+    options.quantum = -1;
+    options.simulate = false;
+    options.coroutines = false;
+    options.daemon = false;
+    options.daemonOptions = DefaultDaemonOptions();
+    options.batch = false;
+    options.threads = 0;
+    options.calibrate = false;
+    options.prefork = false;
+    options.quiet = false;
+    options.maxChildren = 0;
+    options.adaptivePercentile = 0;
+    options.quantumWindow = kDefaultQuantumWindow;
+    options.checkpointEvery = kDefaultCheckpointEvery;
+    options.admission = DefaultAdmissionControl();
+
+    // options come first, the positional arguments keep their old meaning
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--simulate")
+        {
+            options.simulate = true;
+        }
+        else if (argument == "--coroutines")
+        {
+            options.coroutines = true;
+        }
+        else if (argument == "--daemon")
+        {
+            options.daemon = true;
+        }
+        else if (argument == "--socket" && hasValue)
+        {
+            options.daemonOptions.socketPath = argv[++i];
+        }
+        else if (argument == "--queue-limit" && hasValue)
+        {
+            if (!ParseCount(argument, argv[++i], options.daemonOptions.queueLimit))
+            {
+                return false;
+            }
+        }
+        else if (argument == "--batch-size" && hasValue)
+        {
+            long batchSize;
+            if (!ParseNumber(argument, argv[++i], batchSize))
+            {
+                return false;
+            }
+            options.daemonOptions.batchSize = batchSize > 0 ? batchSize : 0;
+        }
+        else if (argument == "--batch")
+        {
+            options.batch = true;
+        }
+        else if (argument == "--output" && hasValue)
+        {
+            options.outputFilename = argv[++i];
+        }
+        else if (argument == "--threads" && hasValue)
+        {
+            if (!ParseCount(argument, argv[++i], options.threads))
+            {
+                return false;
+            }
+        }
+        else if (argument == "--calibrate")
+        {
+            options.calibrate = true;
+        }
+        else if (argument == "--switch-cost" && hasValue)
+        {
+            options.switchCost = argv[++i];
+        }
+        else if (argument == "--inner" && hasValue)
+        {
+            options.innerPolicy = argv[++i];
+        }
+        else if (argument == "--weights" && hasValue)
+        {
+            options.weights = argv[++i];
+        }
+        else if (argument == "--prefork")
+        {
+            options.prefork = true;
+        }
+        else if (argument == "--quiet")
+        {
+            options.quiet = true;
+        }
+        else if (argument == "--max-children" && hasValue)
+        {
+            if (!ParseCount(argument, argv[++i], options.maxChildren))
+            {
+                return false;
+            }
+        }
+        else if (argument == "--metrics-socket" && hasValue)
+        {
+            options.metricsSocket = argv[++i];
+        }
+        else if (argument == "--adaptive-quantum" && hasValue)
+        {
+            if (!ParseNumber(argument, argv[++i], options.adaptivePercentile))
+            {
+                return false;
+            }
+        }
+        else if (argument == "--quantum-window" && hasValue)
+        {
+            if (!ParseCount(argument, argv[++i], options.quantumWindow))
+            {
+                return false;
+            }
+        }
+        else if (argument == "--tune" && hasValue)
+        {
+            options.tune = argv[++i];
+        }
+        else if (argument == "--checkpoint" && hasValue)
+        {
+            options.checkpoint = argv[++i];
+        }
+        else if (argument == "--checkpoint-every" && hasValue)
+        {
+            if (!ParseNumber(argument, argv[++i], options.checkpointEvery))
+            {
+                return false;
+            }
+        }
+        else if (argument == "--resume" && hasValue)
+        {
+            options.resume = argv[++i];
+        }
+        else if (argument == "--admission" && hasValue)
+        {
+            options.admission.action = argv[++i];
+        }
+        else if (argument == "--max-ready" && hasValue)
+        {
+            if (!ParseCount(argument, argv[++i], options.admission.maxReadyDepth))
+            {
+                return false;
+            }
+        }
+        else if (argument == "--max-wait" && hasValue)
+        {
+            if (!ParseNumber(argument, argv[++i], options.admission.maxPredictedWait))
+            {
+                return false;
+            }
+            options.admission.maxPredictedWait /= 1000.0;
+        }
+        else if (argument == "--defer-delay" && hasValue)
+        {
+            if (!ParseNumber(argument, argv[++i], options.admission.deferDelay))
+            {
+                return false;
+            }
+            options.admission.deferDelay /= 1000.0;
+        }
+        else if (argument == "--max-deferrals" && hasValue)
+        {
+            if (!ParseNumber(argument, argv[++i], options.admission.maxDeferrals))
+            {
+                return false;
+            }
+        }
+        else if (argument.compare(0, 2, "--") == 0)
+        {
+            std::cout << "Unknown option " << argument << std::endl;
+            return false;
+        }
+        else
+        {
+            positional.push_back(argument);
+        }
+    }
+
+    if (options.calibrate)
+    {
+        return true;
+    }
+
+    // moving nothing per dispatch would leave the daemon spinning on its pending submissions
+    if (options.daemonOptions.batchSize == 0)
+    {
+        std::cout << "--batch-size needs at least one submission per dispatch." << std::endl;
+        return false;
+    }
+
+    if (options.coroutines && (options.simulate || options.prefork))
+    {
+        std::cout << "--coroutines replaces the child processes, it does not combine with --simulate or --prefork."
+                  << std::endl;
+        return false;
+    }
+
+    const AdmissionControl &admission = options.admission;
+    if (!admission.action.empty() &&
+        (!Scheduler::ValidAdmissionAction(admission.action) ||
+         (admission.maxReadyDepth == 0 && admission.maxPredictedWait <= 0)))
+    {
+        std::cout << "--admission takes reject, defer or deprioritize and needs --max-ready or --max-wait." << std::endl;
+        return false;
+    }
+    if (admission.action == "defer" && (admission.deferDelay <= 0 || admission.maxDeferrals < 0))
+    {
+        std::cout << "Deferring needs a positive --defer-delay and a --max-deferrals of at least 0." << std::endl;
+        return false;
+    }
+
+    // checkpoints hold the virtual clock, real children can not be saved with it
+    bool checkpoints = !options.checkpoint.empty() || !options.resume.empty();
+    if (checkpoints && (!options.simulate || options.daemon || options.batch || !options.tune.empty()))
+    {
+        std::cout << "Checkpoints are only supported for plain --simulate runs." << std::endl;
+        return false;
+    }
+    if (options.checkpointEvery <= 0)
+    {
+        std::cout << "--checkpoint-every needs a positive number of dispatches." << std::endl;
+        return false;
+    }
+    // a resumed run keeps the saved policy unless one is given
+    if (!options.resume.empty() && positional.empty())
+    {
+        return true;
+    }
+
+    // the input file is optional in daemon mode, everything can arrive online, and when resuming
+    size_t minimum = options.daemon || !options.resume.empty() ? 1 : 2;
+    if (positional.size() < minimum || (positional.size() > 3 && !options.batch))
+    {
+        std::cout << "Wrong Format!" << std::endl;
+        PrintUsage();
+        return false;
+    }
+
+    options.policy = positional[0];
+    // FAIR slices by the quantum unless the groups run SJF
+    bool usesQuantum = options.policy == "RR" || options.policy == "PRIO" ||
+                       (options.policy == "FAIR" && options.innerPolicy != "SJF");
+    // the optimizer picks the quantum itself
+    bool needsQuantum = usesQuantum && options.tune.empty();
+    size_t next = 1;
+
+    if ((options.adaptivePercentile != 0 || !options.tune.empty()) && !usesQuantum)
+    {
+        std::cout << "Only policies with a quantum can adapt or tune it." << std::endl;
+        return false;
+    }
+    if (options.adaptivePercentile < 0 || options.adaptivePercentile > 100)
+    {
+        std::cout << "The adaptive quantum percentile must lie in (0, 100]." << std::endl;
+        return false;
+    }
+
+    if (needsQuantum && positional.size() > 1)
+    {
+        int quantum_milliseconds;
+        if (!ParseNumber("QUANTUM", positional[next++], quantum_milliseconds))
+        {
+            PrintUsage();
+            return false;
+        }
+        options.quantum = quantum_milliseconds / 1000.0;
+        if (options.quantum <= 0)
+        {
+            std::cout << "Quantum value is missing!" << std::endl;
+            return false;
+        }
+    }
+    else if (needsQuantum)
+    {
+        std::cout << "Quantum value is missing!" << std::endl;
+        return false;
+    }
+
+    if (options.batch)
+    {
+        options.batchInputs.assign(positional.begin() + next, positional.end());
+        if (options.batchInputs.empty() || options.outputFilename.empty())
+        {
+            std::cout << "Batch mode needs input files and --output." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (positional.size() - next > 1)
+    {
+        std::cout << "Only RR, PRIO or FAIR require quantum" << std::endl;
+        return false;
+    }
+    if (next < positional.size() && !options.resume.empty())
+    {
+        std::cout << "A resumed run takes its processes from the checkpoint." << std::endl;
+        return false;
+    }
+    if (next < positional.size())
+    {
+        options.inputFilename = positional[next];
+    }
+    else if (!options.daemon && options.resume.empty())
+    {
+        std::cout << "Wrong Format!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// parses "A=3,B=1" into group weights, false when a weight is missing or not positive
+static bool ParseGroupWeights(const std::string &text, std::vector<std::pair<std::string, double>> &weights)
+{
+    std::istringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        size_t separator = item.find('=');
+        if (separator == std::string::npos || separator == 0)
+        {
+            return false;
+        }
+
+        std::istringstream value(item.substr(separator + 1));
+        double weight;
+        if (!(value >> weight) || !value.eof() || weight <= 0)
+        {
+            return false;
+        }
+        weights.push_back(std::make_pair(item.substr(0, separator), weight));
+    }
+
+    return true;
+}
+
+// ******************************************   main   ******************************************
+
+int main(int argc, char *argv[])
+{
+    std::cout << "------------------------------- WELCOME TO THE CPU SCHEDULER --------------------------------------\n\n\n";
+
+    // first take the commant line arguments from the user
+    CliOptions options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        return 1;
+    }
+
+    if (options.calibrate)
+    {
+        PrintSwitchCosts(std::cout, CalibrateSwitchCosts(kCalibrationSamples));
+        return 0;
+    }
+
+    SchedulerConfig config = DefaultSchedulerConfig(options.policy, options.quantum);
+
+    // resuming without a policy continues with everything the checkpoint was saved with
+    bool savedConfig = !options.resume.empty() && options.policy.empty();
+    if (savedConfig)
+    {
+        if (!ReadCheckpointConfig(options.resume, config))
+        {
+            std::cout << "Error reading checkpoint " << options.resume << "." << std::endl;
+            return 1;
+        }
+        options.policy = config.policy;
+        options.quantum = config.quantum;
+        options.innerPolicy = config.innerPolicy;
+        options.adaptivePercentile = config.adaptivePercentile;
+        options.quantumWindow = config.adaptiveWindow;
+    }
+
+    if (!Scheduler::ValidPolicy(options.policy))
+    {
+        std::cout << "Invalid policy." << std::endl;
+        return 1;
+    }
+
+    config.innerPolicy = options.innerPolicy;
+    if (!config.innerPolicy.empty() && (options.policy != "FAIR" || !Scheduler::ValidInnerPolicy(config.innerPolicy)))
+    {
+        std::cout << "--inner takes RR, SJF or PRIO and only applies to FAIR." << std::endl;
+        return 1;
+    }
+    // given weights replace saved ones
+    if (!options.weights.empty())
+    {
+        config.groupWeights.clear();
+    }
+    if (!ParseGroupWeights(options.weights, config.groupWeights))
+    {
+        std::cout << "Group weights must look like GROUP=WEIGHT,... with positive weights." << std::endl;
+        return 1;
+    }
+
+    // context switch cost charged on the scheduler clock, measured before any handler is installed
+    double switchCost = config.switchCost;
+    if (options.switchCost == "measured")
+    {
+        SwitchCosts costs = CalibrateSwitchCosts(kCalibrationSamples);
+        PrintSwitchCosts(std::cout, costs);
+        switchCost = ContextSwitchCost(costs);
+    }
+    else if (!options.switchCost.empty())
+    {
+        if (!ParseNumber("--switch-cost", options.switchCost, switchCost))
+        {
+            return 1;
+        }
+        switchCost /= 1000.0;
+        if (switchCost < 0)
+        {
+            std::cout << "Context switch cost can not be negative." << std::endl;
+            return 1;
+        }
+    }
+    config.switchCost = switchCost;
+    config.adaptivePercentile = options.adaptivePercentile;
+    config.adaptiveWindow = options.quantumWindow;
+    // a resumed run keeps its admission control unless new one is asked for
+    if (!savedConfig || !options.admission.action.empty())
+    {
+        config.admission = options.admission;
+    }
+
+    // only priorities can be lowered
+    bool priorities = config.policy == "PRIO" || (config.policy == "FAIR" && config.innerPolicy == "PRIO");
+    if (config.admission.action == "deprioritize" && !priorities)
+    {
+        std::cout << "Deprioritizing needs PRIO or FAIR with --inner PRIO." << std::endl;
+        return 1;
+    }
+
+    if (!options.tune.empty())
+    {
+        if (!ValidTuneObjective(options.tune))
+        {
+            std::cout << "--tune takes mean or p99." << std::endl;
+            return 1;
+        }
+
+        // simulated like batch mode, every candidate quantum runs the whole workload
+        std::vector<ProcessProfile> workload;
+        auto Collect = [&workload](const ProcessProfile &process) { workload.push_back(process); };
+        if (ReadProcessFile(options.inputFilename, Collect) < 0)
+        {
+            std::cout << "Error opening input file." << std::endl;
+            return 1;
+        }
+
+        std::vector<QuantumTrial> trials = TuneQuantum(config, workload, CandidateQuanta(workload, kTuneCandidates),
+                                                       options.threads);
+        if (trials.empty())
+        {
+            std::cout << "No process to tune the quantum for." << std::endl;
+            return 1;
+        }
+
+        size_t best = BestTrial(trials, options.tune);
+        PrintTrials(std::cout, trials, best);
+        std::cout << "\nBest quantum for " << options.tune << " turnaround: " << trials[best].quantum * 1000
+                  << " milliseconds" << std::endl;
+        return 0;
+    }
+
+    if (options.batch)
+    {
+        // batch runs are always simulated: no children, no signal handlers, no trailing sleep
+        std::vector<std::string> files = CollectWorkloads(options.batchInputs);
+        std::vector<BatchResult> results = RunBatch(config, files, options.threads);
+        if (!WriteBatchResults(options.outputFilename, config, results))
+        {
+            std::cout << "Error writing results file " << options.outputFilename << "." << std::endl;
+            return 1;
+        }
+        std::cout << "Scheduled " << results.size() << " input files, results in " << options.outputFilename << std::endl;
+        return 0;
+    }
+
+    Scheduler scheduler(options.policy, options.quantum);
+    ApplyConfig(scheduler, config);
+
+    // counters are published from the first submission on, scraped from another thread
+    SchedulerMetrics metrics;
+    MetricsServer metricsServer(metrics);
+    if (!options.metricsSocket.empty())
+    {
+        if (!metricsServer.Start(options.metricsSocket))
+        {
+            return 1;
+        }
+        scheduler.SetMetrics(&metrics);
+        std::cout << "Serving metrics on " << options.metricsSocket << std::endl;
+    }
+
+    // insert processes from the input file into the queue
+    if (!options.inputFilename.empty() && scheduler.LoadFile(options.inputFilename) < 0)
+    {
+        std::cout << "Error opening input file." << std::endl;
+        return 1;
+    }
+
+    // or take queues, clock and statistics from where a previous run left off
+    if (!options.resume.empty())
+    {
+        if (!scheduler.RestoreCheckpoint(options.resume))
+        {
+            std::cout << "Error reading checkpoint " << options.resume << "." << std::endl;
+            return 1;
+        }
+        std::cout << "Resumed at time " << scheduler.Time() << " with " << scheduler.Stats().completed << " of "
+                  << scheduler.Stats().processCount << " processes completed.\n" << std::endl;
+    }
+    if (!options.checkpoint.empty())
+    {
+        scheduler.SetCheckpointing(options.checkpoint, options.checkpointEvery);
+    }
+
+    bool verbose = !options.quiet && !options.daemon;
+    if (verbose)
+    {
+        scheduler.SetLog(&std::cout);
+    }
+
+    // coroutines run in this process, no limits to raise and no signals to forward
+    CoroutineExecutor coroutineExecutor;
+    // every process runs as a real child controlled with signals, unless only simulating
+    // or on coroutines; only then the shared table is mapped
+    std::unique_ptr<ForkExecutor> forkExecutor;
+    if (options.coroutines)
+    {
+        scheduler.SetExecutor(&coroutineExecutor);
+    }
+    else if (!options.simulate)
+    {
+        // the shared table needs an entry per child that can be alive at the same time
+        size_t maxChildren = options.maxChildren;
+        if (maxChildren == 0)
+        {
+            maxChildren = std::max<size_t>(kDefaultMaxChildren, scheduler.Stats().processCount);
+        }
+        forkExecutor.reset(new ForkExecutor(maxChildren));
+        // the mmap error has been printed already
+        if (!forkExecutor->Valid())
+        {
+            return 1;
+        }
+        if (verbose)
+        {
+            forkExecutor->SetLog(&std::cout);
+        }
+
+        // RR and PRIO keep every child alive after its first slice, not only with --prefork
+        RaiseProcessLimits(scheduler.Stats().processCount, std::cout);
+        if (!InstallSignalHandlers(forkExecutor.get()))
+        {
+            return 1;
+        }
+        std::cout << "Signal handlers set up.\n" << std::endl;
+
+        // with --prefork every loaded process gets its stopped child here
+        forkExecutor->SetPrefork(options.prefork);
+        scheduler.SetExecutor(forkExecutor.get());
+    }
+
+    if (options.daemon)
+    {
+        return RunDaemon(scheduler, options.daemonOptions);
+    }
+
+    // apply the scheduling policy based on the user preference
+    scheduler.Run();
+    if (options.quiet)
+    {
+        PrintReport(std::cout, scheduler);
+    }
+
+    std::cout << " #################### CPU SCHEDULER IS DONE !!!!!!!!!!!!!!  #######################\n";
+
+    return 0;
+}
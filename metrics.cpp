@@ -0,0 +1,326 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "unix_socket.h"
+
+// lower bound of the second bucket, the first one holds everything shorter
+static const double kLatencyResolution = 1e-6;
+
+int LatencyBucket(double seconds, int buckets)
+{
+    if (seconds < kLatencyResolution)
+    {
+        return 0;
+    }
+
+    int bucket = 1 + (int)std::floor(4 * std::log2(seconds / kLatencyResolution));
+    return bucket < buckets ? bucket : buckets - 1;
+}
+
+double LatencyBucketLimit(int bucket)
+{
+    return kLatencyResolution * std::exp2(bucket / 4.0);
+}
+
+double LatencyPercentile(const long *counts, int buckets, double fraction, double smallest, double largest)
+{
+    long total = 0;
+    for (int i = 0; i < buckets; i++)
+    {
+        total += counts[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // nearest rank, placed linearly inside the bucket that holds it
+    long rank = std::max(1L, (long)std::ceil(fraction * total));
+    long seen = 0;
+    double estimate = LatencyBucketLimit(buckets - 1);
+    for (int i = 0; i < buckets; i++)
+    {
+        if (seen + counts[i] >= rank && counts[i] > 0)
+        {
+            double lower = i > 0 ? LatencyBucketLimit(i - 1) : 0;
+            double upper = LatencyBucketLimit(i);
+            estimate = lower + (upper - lower) * (rank - seen) / counts[i];
+            break;
+        }
+        seen += counts[i];
+    }
+
+    // never outside the values that were actually recorded
+    return std::min(std::max(estimate, smallest), largest);
+}
+
+// ----------------------------------   COUNTERS   --------------------------------------
+
+SchedulerMetrics::SchedulerMetrics()
+    : groupCount(0), blockedDepth(0), dispatches(0), contextSwitches(0), preemptions(0), completed(0),
+      lastOvershoot(0), overshootTotal(0), clock(0), cpuBusyTime(0), waitingTotal(0), turnaroundTotal(0)
+{
+    for (int i = 0; i < kMetricGroups; i++)
+    {
+        groups[i].readyDepth.store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < kWaitingBuckets; i++)
+    {
+        waitingBuckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// only the scheduling loop writes, so a load and a store need no read-modify-write
+void SchedulerMetrics::Add(std::atomic<double> &value, double amount)
+{
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+int SchedulerMetrics::AddGroup(const std::string &name)
+{
+    int count = groupCount.load(std::memory_order_relaxed);
+    if (count == kMetricGroups)
+    {
+        return kMetricGroups - 1;
+    }
+
+    // the name is complete before readers can see the slot
+    groups[count].name = count == kMetricGroups - 1 ? "other" : name;
+    groupCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void SchedulerMetrics::ReadyChanged(int group, long delta)
+{
+    groups[group].readyDepth.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void SchedulerMetrics::BlockedChanged(long delta)
+{
+    blockedDepth.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void SchedulerMetrics::Dispatched(bool switched)
+{
+    dispatches.fetch_add(1, std::memory_order_relaxed);
+    if (switched)
+    {
+        contextSwitches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SchedulerMetrics::Preempted()
+{
+    preemptions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SchedulerMetrics::SliceOvershoot(double seconds)
+{
+    lastOvershoot.store(seconds, std::memory_order_relaxed);
+    Add(overshootTotal, seconds);
+}
+
+void SchedulerMetrics::Completed(double waitingTime, double turnaroundTime)
+{
+    waitingBuckets[LatencyBucket(waitingTime, kWaitingBuckets)].fetch_add(1, std::memory_order_relaxed);
+    Add(waitingTotal, waitingTime);
+    Add(turnaroundTotal, turnaroundTime);
+    completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SchedulerMetrics::ClockAdvanced(double time, double cpuBusyTime)
+{
+    clock.store(time, std::memory_order_relaxed);
+    this->cpuBusyTime.store(cpuBusyTime, std::memory_order_relaxed);
+}
+
+double SchedulerMetrics::WaitingPercentile(double fraction) const
+{
+    long counts[kWaitingBuckets];
+    for (int i = 0; i < kWaitingBuckets; i++)
+    {
+        counts[i] = waitingBuckets[i].load(std::memory_order_relaxed);
+    }
+    return LatencyPercentile(counts, kWaitingBuckets, fraction, 0, HUGE_VAL);
+}
+
+// group names come from the input file, the text format wants backslash, double quote and newline escaped in labels
+static std::string LabelValue(const std::string &value)
+{
+    std::string escaped;
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (c == '\n')
+        {
+            escaped += "\\n";
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void SchedulerMetrics::WritePrometheus(std::ostream &out, double dispatchRate) const
+{
+    int count = groupCount.load(std::memory_order_acquire);
+
+    out << "# HELP scheduler_ready_depth Processes in the ready queue of a group.\n"
+        << "# TYPE scheduler_ready_depth gauge\n";
+    for (int i = 0; i < count; i++)
+    {
+        out << "scheduler_ready_depth{group=\"" << LabelValue(groups[i].name) << "\"} "
+            << groups[i].readyDepth.load(std::memory_order_relaxed) << "\n";
+    }
+
+    out << "# HELP scheduler_blocked_depth Processes waiting for the I/O device.\n"
+        << "# TYPE scheduler_blocked_depth gauge\n"
+        << "scheduler_blocked_depth " << blockedDepth.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_dispatches_total Slices handed out.\n"
+        << "# TYPE scheduler_dispatches_total counter\n"
+        << "scheduler_dispatches_total " << dispatches.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_dispatches_per_second Dispatch rate since the previous scrape.\n"
+        << "# TYPE scheduler_dispatches_per_second gauge\n"
+        << "scheduler_dispatches_per_second " << dispatchRate << "\n"
+        << "# HELP scheduler_context_switches_total Dispatches that changed the running process.\n"
+        << "# TYPE scheduler_context_switches_total counter\n"
+        << "scheduler_context_switches_total " << contextSwitches.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_preemptions_total Slices that ended before the CPU burst did.\n"
+        << "# TYPE scheduler_preemptions_total counter\n"
+        << "scheduler_preemptions_total " << preemptions.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_slice_overshoot_seconds Time the last slice ran past its length.\n"
+        << "# TYPE scheduler_slice_overshoot_seconds gauge\n"
+        << "scheduler_slice_overshoot_seconds " << lastOvershoot.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_slice_overshoot_seconds_total Time all slices ran past their length.\n"
+        << "# TYPE scheduler_slice_overshoot_seconds_total counter\n"
+        << "scheduler_slice_overshoot_seconds_total " << overshootTotal.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_clock_seconds Current value of the scheduler clock.\n"
+        << "# TYPE scheduler_clock_seconds gauge\n"
+        << "scheduler_clock_seconds " << clock.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_cpu_busy_seconds_total Clock time the CPU spent running slices.\n"
+        << "# TYPE scheduler_cpu_busy_seconds_total counter\n"
+        << "scheduler_cpu_busy_seconds_total " << cpuBusyTime.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_turnaround_seconds_total Turnaround time of the finished processes.\n"
+        << "# TYPE scheduler_turnaround_seconds_total counter\n"
+        << "scheduler_turnaround_seconds_total " << turnaroundTotal.load(std::memory_order_relaxed) << "\n"
+        << "# HELP scheduler_waiting_seconds Time finished processes spent in the ready queue.\n"
+        << "# TYPE scheduler_waiting_seconds summary\n";
+
+    const double quantiles[] = {0.5, 0.9, 0.99};
+    for (double quantile : quantiles)
+    {
+        out << "scheduler_waiting_seconds{quantile=\"" << quantile << "\"} " << WaitingPercentile(quantile) << "\n";
+    }
+    out << "scheduler_waiting_seconds_sum " << waitingTotal.load(std::memory_order_relaxed) << "\n"
+        << "scheduler_waiting_seconds_count " << completed.load(std::memory_order_relaxed) << "\n";
+}
+
+// ----------------------------------   SERVER   --------------------------------------
+
+MetricsServer::MetricsServer(const SchedulerMetrics &metrics)
+    : metrics(metrics), listenFd(-1), running(false), lastDispatches(0),
+      lastScrape(std::chrono::steady_clock::now())
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    Stop();
+}
+
+bool MetricsServer::Start(const std::string &socketPath)
+{
+    listenFd = OpenListeningSocket(socketPath);
+    if (listenFd == -1)
+    {
+        return false;
+    }
+
+    this->socketPath = socketPath;
+    running = true;
+    server = std::thread(&MetricsServer::Serve, this);
+    return true;
+}
+
+void MetricsServer::Stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    running = false;
+    server.join();
+    close(listenFd);
+    unlink(socketPath.c_str());
+    listenFd = -1;
+}
+
+void MetricsServer::Serve()
+{
+    AcceptConnections(listenFd, [this]() { return running.load(); }, [this](int clientFd)
+    {
+        Respond(clientFd);
+        close(clientFd);
+    });
+}
+
+void MetricsServer::Respond(int clientFd)
+{
+    // the request itself does not matter, read what the client sent so closing does not reset it
+    struct pollfd client = {clientFd, POLLIN, 0};
+    if (poll(&client, 1, 100) > 0)
+    {
+        char request[1024];
+        ssize_t received;
+        while ((received = recv(clientFd, request, sizeof(request), MSG_DONTWAIT)) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    long dispatches = metrics.Dispatches();
+    double elapsed = std::chrono::duration<double>(now - lastScrape).count();
+    double dispatchRate = elapsed > 0 ? (dispatches - lastDispatches) / elapsed : 0;
+    lastDispatches = dispatches;
+    lastScrape = now;
+
+    std::ostringstream body;
+    metrics.WritePrometheus(body, dispatchRate);
+
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.str().size() << "\r\n\r\n"
+             << body.str();
+
+    // MSG_NOSIGNAL: a scraper that went away must not kill the scheduler with SIGPIPE
+    std::string text = response.str();
+    size_t sent = 0;
+    while (sent < text.size())
+    {
+        ssize_t written = send(clientFd, text.c_str() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            break;
+        }
+        sent += written;
+    }
+}
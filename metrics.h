@@ -0,0 +1,104 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// ----------------------------------   LIVE METRICS   --------------------------------------
+//
+// Counters and gauges written by the scheduling loop and read by the metrics
+// server thread. There is one writer, so every update is a relaxed atomic
+// store or increment and the loop never takes a lock or makes a system call.
+
+static const int kMetricGroups = 64;          // groups beyond this are folded into the last one
+static const int kWaitingBuckets = 128;       // four buckets per doubling, starting at 1 microsecond
+
+// log-scale latency histograms: four buckets per doubling from 1 microsecond, the
+// first bucket holds everything shorter and the last everything beyond the range
+int LatencyBucket(double seconds, int buckets);
+double LatencyBucketLimit(int bucket);
+// nearest rank percentile, interpolated inside its bucket and clamped to the smallest and
+// largest value recorded; within one bucket (19 %) of the exact value, 0 without counts
+double LatencyPercentile(const long *counts, int buckets, double fraction, double smallest, double largest);
+
+struct GroupMetrics
+{
+    std::string name;                          // written once, before the group is published
+    std::atomic<long> readyDepth;
+};
+
+class SchedulerMetrics
+{
+public:
+    SchedulerMetrics();
+
+    // ---- written by the scheduling loop ----
+    // returns the slot of a group, publishing its name the first time
+    int AddGroup(const std::string &name);
+    void ReadyChanged(int group, long delta);
+    void BlockedChanged(long delta);
+    void Dispatched(bool switched);
+    void Preempted();
+    // wall time the executor actually needed for a slice, beyond the planned one
+    void SliceOvershoot(double seconds);
+    void Completed(double waitingTime, double turnaroundTime);
+    void ClockAdvanced(double time, double cpuBusyTime);
+
+    // ---- read by any thread ----
+    // waiting time below which the given fraction of the finished processes waited
+    double WaitingPercentile(double fraction) const;
+    void WritePrometheus(std::ostream &out, double dispatchRate) const;
+    long Dispatches() const { return dispatches.load(std::memory_order_relaxed); }
+
+private:
+    static void Add(std::atomic<double> &value, double amount);
+
+    GroupMetrics groups[kMetricGroups];
+    std::atomic<int> groupCount;
+    std::atomic<long> blockedDepth;
+    std::atomic<long> dispatches;
+    std::atomic<long> contextSwitches;
+    std::atomic<long> preemptions;
+    std::atomic<long> completed;
+    std::atomic<double> lastOvershoot;
+    std::atomic<double> overshootTotal;
+    std::atomic<double> clock;
+    std::atomic<double> cpuBusyTime;
+    std::atomic<double> waitingTotal;
+    std::atomic<double> turnaroundTotal;
+    std::atomic<long> waitingBuckets[kWaitingBuckets];
+};
+
+// serves the metrics in the Prometheus text format on a Unix domain socket, one
+// HTTP response per connection:  curl --unix-socket PATH http://localhost/metrics
+class MetricsServer
+{
+public:
+    explicit MetricsServer(const SchedulerMetrics &metrics);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    // false when the socket can not be created
+    bool Start(const std::string &socketPath);
+    void Stop();
+
+private:
+    void Serve();
+    void Respond(int clientFd);
+
+    const SchedulerMetrics &metrics;
+    std::string socketPath;
+    int listenFd;
+    std::atomic<bool> running;
+    std::thread server;
+    // rate of the previous scrape, only touched by the server thread
+    long lastDispatches;
+    std::chrono::steady_clock::time_point lastScrape;
+};
+
+#endif
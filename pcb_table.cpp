@@ -0,0 +1,59 @@
+#include "pcb_table.h"
+
+#include <cstdio>
+#include <sys/mman.h>
+
+SharedProcessTable::SharedProcessTable(size_t capacity) : entries(nullptr), capacity(capacity)
+{
+    // anonymous shared memory is inherited by every child forked afterwards;
+    // pages are only backed once an entry is touched
+    void *mapping = mmap(nullptr, capacity * sizeof(SharedProcessState), PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        perror("Error mapping the shared process table");
+        this->capacity = 0;
+        return;
+    }
+
+    entries = static_cast<SharedProcessState *>(mapping);
+
+    // lowest slots are handed out first
+    freeSlots.reserve(capacity);
+    for (size_t slot = capacity; slot > 0; slot--)
+    {
+        freeSlots.push_back((int)slot - 1);
+    }
+}
+
+SharedProcessTable::~SharedProcessTable()
+{
+    if (entries != nullptr)
+    {
+        munmap(entries, capacity * sizeof(SharedProcessState));
+    }
+}
+
+int SharedProcessTable::Acquire()
+{
+    if (freeSlots.empty())
+    {
+        return -1;
+    }
+
+    int slot = freeSlots.back();
+    freeSlots.pop_back();
+
+    SharedProcessState &entry = entries[slot];
+    entry.pid.store(-1, std::memory_order_relaxed);
+    entry.status.store(0, std::memory_order_relaxed);
+    entry.progressTicks.store(0, std::memory_order_relaxed);
+    entry.heartbeat.store(0, std::memory_order_relaxed);
+
+    return slot;
+}
+
+void SharedProcessTable::Release(int slot)
+{
+    freeSlots.push_back(slot);
+}
@@ -0,0 +1,55 @@
+#ifndef PCB_TABLE_H
+#define PCB_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// ----------------------------------   SHARED PCB TABLE   --------------------------------------
+//
+// One entry per live child, mapped MAP_SHARED before the children are forked.
+// A child only writes its own entry: its progress, heartbeat and status. The
+// parent stores pid and status when it starts, stops, resumes or reaps the
+// child and reads the rest with plain atomic loads, so observing progress and
+// state costs no system call.
+
+struct SharedProcessState
+{
+    std::atomic<int> pid;
+    std::atomic<int> status;           // ImplementationStatus
+    std::atomic<long> progressTicks;   // CPU ticks the child has executed
+    std::atomic<long> heartbeat;       // bumped by the child on every tick
+    char padding[64 - 2 * sizeof(std::atomic<int>) - 2 * sizeof(std::atomic<long>)];
+};
+
+// the table is shared between processes, so the atomics must not hide a lock
+static_assert(std::atomic<int>::is_always_lock_free && std::atomic<long>::is_always_lock_free,
+              "the shared PCB table needs lock free atomics");
+static_assert(sizeof(SharedProcessState) == 64, "one PCB entry per cache line");
+
+class SharedProcessTable
+{
+public:
+    explicit SharedProcessTable(size_t capacity);
+    ~SharedProcessTable();
+
+    SharedProcessTable(const SharedProcessTable &) = delete;
+    SharedProcessTable &operator=(const SharedProcessTable &) = delete;
+
+    // false when the mapping failed
+    bool Valid() const { return entries != nullptr; }
+    size_t Capacity() const { return capacity; }
+
+    // hands out a cleared entry, -1 when every entry is in use
+    int Acquire();
+    void Release(int slot);
+
+    SharedProcessState &Entry(int slot) { return entries[slot]; }
+
+private:
+    SharedProcessState *entries;
+    size_t capacity;
+    std::vector<int> freeSlots;
+};
+
+#endif
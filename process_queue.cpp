@@ -0,0 +1,297 @@
+#include "process_queue.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+// ----------------------------------   QUEUE FUNCTIONS   --------------------------------------
+
+ProcessProfile MakeProcess(const std::string &name, int priority, double burstTime)
+{
+    return MakeProcess(name, priority, std::vector<double>(1, burstTime));
+}
+
+ProcessProfile MakeProcess(const std::string &name, int priority, const std::vector<double> &bursts)
+{
+    ProcessProfile process;
+    process.name = name;
+    process.group = "default";
+    process.groupIndex = -1;
+    process.id = -1;
+    process.pid = -1;
+    process.slot = -1;
+    process.deferrals = 0;
+    process.status = ImplementationStatus::READY;
+    process.priority = priority;
+    process.bursts = bursts;
+    process.burst_time = 0;
+    process.io_time = 0;
+    for (size_t i = 0; i < bursts.size(); i++)
+    {
+        // even positions are CPU bursts, odd positions I/O bursts
+        if (i % 2 == 0)
+        {
+            process.burst_time += bursts[i];
+        }
+        else
+        {
+            process.io_time += bursts[i];
+        }
+    }
+    process.turnaround_time = 0;
+    process.total_waiting_time = 0;
+    process.remain_time = process.burst_time;
+    process.burstIndex = 0;
+    process.burstRemaining = bursts.empty() ? 0 : bursts[0];
+    process.arrivalTime = 0;
+    process.startTime = 0;
+    process.endTime = 0;
+    process.readySince = 0;
+    process.blockedSince = 0;
+
+    return process;
+}
+
+bool ParseProcessLine(const std::string &line, ProcessProfile &process)
+{
+    std::istringstream iss(line);
+    std::string process_name;
+    int prior;
+    std::vector<double> bursts;
+    double burst;
+
+    if (!(iss >> process_name >> prior))
+    {
+        return false;
+    }
+
+    while (iss >> burst)
+    {
+        if (burst <= 0)
+        {
+            return false;
+        }
+        bursts.push_back(burst);
+    }
+
+    // a trailing I/O burst is malformed
+    if (bursts.size() % 2 == 0)
+    {
+        return false;
+    }
+    process = MakeProcess(process_name, prior, bursts);
+
+    // the bursts may be followed by key=value options, anything else is malformed
+    if (!iss.eof())
+    {
+        iss.clear();
+        std::string option;
+        while (iss >> option)
+        {
+            if (option.compare(0, 6, "group=") == 0 && option.size() > 6)
+            {
+                process.group = option.substr(6);
+            }
+            else if (option.compare(0, 8, "arrival=") == 0)
+            {
+                std::istringstream value(option.substr(8));
+                if (!(value >> process.arrivalTime) || !value.eof() || process.arrivalTime < 0)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int ReadProcessFile(const std::string &filename, const std::function<void(const ProcessProfile &)> &onProcess)
+{
+    std::ifstream inputFile(filename);
+    if (!inputFile.is_open())
+    {
+        return -1;
+    }
+
+    int loaded = 0;
+    std::string line;
+    while (std::getline(inputFile, line))
+    {
+        ProcessProfile process;
+        if (ParseProcessLine(line, process))
+        {
+            onProcess(process);
+            loaded++;
+        }
+    }
+
+    inputFile.close();
+
+    return loaded;
+}
+
+void InitializeQueue(Queue &queue)
+{
+    queue.head = nullptr;
+    queue.tail = nullptr;
+}
+
+void ClearQueue(Queue &queue)
+{
+    Node *current = queue.head;
+
+    while (current != nullptr)
+    {
+        Node *next = current->next;
+        delete current;
+        current = next;
+    }
+
+    InitializeQueue(queue);
+}
+
+//***********************************     adding and removing process from the queue    ****************************************
+
+void AppendNode(Queue &queue, Node *node)
+{
+    node->prev = nullptr;
+    node->next = nullptr;
+
+    if (queue.head == nullptr)
+    {
+        // if the queue is empty, the node becomes the first one
+        queue.head = node;
+        queue.tail = node;
+    }
+    else
+    {
+        node->prev = queue.tail;
+        queue.tail->next = node;
+        queue.tail = node;
+    }
+}
+
+void UnlinkNode(Queue &queue, Node *node)
+{
+    if (node->prev != nullptr)
+    {
+        node->prev->next = node->next;
+    }
+    else
+    {
+        queue.head = node->next;
+    }
+
+    if (node->next != nullptr)
+    {
+        node->next->prev = node->prev;
+    }
+    else
+    {
+        queue.tail = node->prev;
+    }
+
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+void DeleteProcess(Queue &queue, pid_t pidToDelete)
+{
+    Node *current = queue.head;
+
+    while (current != nullptr)
+    {
+        if (current->processDescription.pid == pidToDelete)
+        {
+            // found the process with the specified PID, remove it from the queue
+            UnlinkNode(queue, current);
+            delete current;
+
+            return;
+        }
+
+        current = current->next;
+    }
+
+    // if the process with the specified PID was not found in the queue
+    std::cerr << "Process with PID " << pidToDelete << " not found in the queue." << std::endl;
+}
+
+Node *AddProcess(Queue &queue, const ProcessProfile &process)
+{
+    // create a new node for the new process
+    Node *newNode = new Node;
+
+    if (newNode == nullptr)
+    {
+        std::cout << "Error: Memory allocation failed ." << std::endl;
+        exit(1);
+    }
+
+    newNode->processDescription = process;
+    AppendNode(queue, newNode);
+
+    return newNode;
+}
+
+bool EmptyQueue(const Queue &queue)
+{
+    return queue.head == nullptr;
+}
+
+int CountProcesses(const Queue &queue)
+{
+    int count = 0;
+    Node *process = queue.head;
+
+    while (process != nullptr)
+    {
+        count++;
+        process = process->next;
+    }
+
+    return count;
+}
+
+Node *ShortestProcess(const Queue &queue)
+{
+    Node *shortest = nullptr;
+    Node *process = queue.head;
+
+    while (process != nullptr)
+    {
+        // the next CPU burst, which is the whole burst time for single burst processes
+        if (shortest == nullptr || process->processDescription.burstRemaining < shortest->processDescription.burstRemaining)
+        {
+            shortest = process;
+        }
+
+        process = process->next; // Move to the next process in the queue
+    }
+
+    return shortest;
+}
+
+Node *HighestPriority(const Queue &queue)
+{
+    Node *highestPriority = nullptr;
+    Node *process = queue.head;
+
+    while (process != nullptr)
+    {
+        if (highestPriority == nullptr || process->processDescription.priority < highestPriority->processDescription.priority)
+        {
+            highestPriority = process;
+        }
+
+        process = process->next;
+    }
+
+    return highestPriority;
+}
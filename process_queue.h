@@ -0,0 +1,89 @@
+#ifndef PROCESS_QUEUE_H
+#define PROCESS_QUEUE_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+//---------------------------------------   DATA STRUCTURES TO HOLD THE DATA --------------------------------------------
+
+enum ImplementationStatus
+{
+    READY,
+    RUNNING,
+    STOPPED,
+    EXITED,
+    BLOCKED,    // waiting for the I/O device
+    FAILED      // its execution died before it finished
+};
+
+// process control block (PCB)
+struct ProcessProfile
+{
+    std::string name;
+    std::string group;         // tenant the process belongs to, "default" when not given
+    int groupIndex;            // index of the group inside its Scheduler
+    int id;                    // submission order, unique within a Scheduler
+    double burst_time;         // total CPU time over all CPU bursts
+    int priority;
+    int pid;
+    int slot;                  // entry of the child in the shared PCB table, -1 when none
+    int deferrals;             // times admission control postponed the arrival
+    double remain_time;        // CPU time still to run over all CPU bursts
+    double turnaround_time;
+    double total_waiting_time; // time spent in the ready queue
+    double arrivalTime;
+    double startTime;
+    double endTime;
+    ImplementationStatus status;
+
+    // alternating CPU and I/O bursts, starting and ending with a CPU burst
+    std::vector<double> bursts;
+    int burstIndex;            // burst currently executing or waiting for the device
+    double burstRemaining;     // time left of the current CPU burst
+    double io_time;            // total I/O time over all I/O bursts
+    double readySince;         // last time the process entered the ready queue
+    double blockedSince;       // last time the process entered the blocked queue
+};
+
+struct Node
+{
+    ProcessProfile processDescription;
+    Node *prev;
+    Node *next;
+};
+
+struct Queue
+{
+    Node *head;
+    Node *tail;
+};
+
+// builds a READY process control block with no child attached yet
+ProcessProfile MakeProcess(const std::string &name, int priority, double burstTime);
+ProcessProfile MakeProcess(const std::string &name, int priority, const std::vector<double> &bursts);
+
+// parses a "<process_name> <priority> <cpu_burst> [<io_burst> <cpu_burst>]... [group=<name>] [arrival=<time>]" input line
+bool ParseProcessLine(const std::string &line, ProcessProfile &process);
+// hands every valid line of an input file to onProcess in file order,
+// returns how many there were or -1 when the file cannot be opened
+int ReadProcessFile(const std::string &filename, const std::function<void(const ProcessProfile &)> &onProcess);
+
+void InitializeQueue(Queue &queue);
+void ClearQueue(Queue &queue);
+
+// adding and removing process from the queue
+Node *AddProcess(Queue &queue, const ProcessProfile &process);
+void DeleteProcess(Queue &queue, pid_t pidToDelete);
+
+// relinking an existing node, no allocation
+void AppendNode(Queue &queue, Node *node);
+void UnlinkNode(Queue &queue, Node *node);
+
+bool EmptyQueue(const Queue &queue);
+int CountProcesses(const Queue &queue);
+Node *ShortestProcess(const Queue &queue);
+Node *HighestPriority(const Queue &queue);
+
+#endif
@@ -1,960 +1,1258 @@
-#include <iostream>
-#include <string>
-#include <vector>
-#include <sstream>
-#include <fstream>
-#include <unistd.h>
-#include <sys/wait.h>
-#include <sys/time.h>
+#include "scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
 #include <cmath>
-#include <signal.h>
-#include <cstring>
 
-using namespace std;
-//---------------------------------------   GLOBAL VARIABLES  AND DATA STRUCTURES TO HOLD THE DATA --------------------------------------------
+#include "checkpoint.h"
 
-enum ImplementationStatus
-{
-    READY,
-    RUNNING,
-    STOPPED,
-    EXITED
-};
+// remaining times below this are rounding leftovers of fractional slices
+static const double kTimeEpsilon = 1e-9;
+// an adaptive quantum stays at least this long, and at least this many context switch costs
+static const double kMinAdaptiveQuantum = 0.001;
+static const double kMinQuantumPerSwitch = 10;
 
-// process control block (PCB)
-struct ProcessProfile
-{
-    std::string name;
-    int burst_time;
-    int priority;
-    int pid;
-    int remain_time;
-    double turnaround_time;
-    double total_waiting_time;
-    int startTime;
-    int endTime;
-    ImplementationStatus status;
-};
+// ----------------------------------   SCHEDULER   --------------------------------------
 
-struct Node
+Scheduler::Scheduler(const std::string &policy, double quantum)
+    : policy(policy), innerPolicy(policy == "FAIR" ? "RR" : policy), quantum(quantum), switchCost(0),
+      adaptivePercentile(0), adaptiveWindow(0), recentNext(0), nextId(0),
+      lastDispatched(-1), fairClock(0), readyCount(0), deviceFreeAt(0), executor(nullptr), metrics(nullptr),
+      log(nullptr), checkpointEvery(0), lastCheckpoint(0)
 {
-    ProcessProfile processDescription;
-    Node *prev;
-    Node *next;
-};
+    InitializeQueue(queue);
+    InitializeQueue(blocked);
+
+    stats.processCount = 0;
+    stats.completed = 0;
+    stats.failed = 0;
+    stats.dispatches = 0;
+    stats.totalWaitingTime = 0;
+    stats.totalTurnaroundTime = 0;
+    stats.time = 0;
+    stats.cpuBusyTime = 0;
+    stats.deviceBusyTime = 0;
+    stats.contextSwitches = 0;
+    stats.switchTime = 0;
+    stats.admitted = 0;
+    stats.rejected = 0;
+    stats.deferrals = 0;
+    stats.deprioritized = 0;
+
+    admission = DefaultAdmissionControl();
+    for (int i = 0; i < kTurnaroundBuckets; i++)
+    {
+        turnaroundBuckets[i] = 0;
+    }
+    shortestTurnaround = 0;
+    longestTurnaround = 0;
+}
 
-struct Queue
+Scheduler::~Scheduler()
 {
-    Node *head;
-    Node *tail;
-};
+    ClearQueue(queue);
+    ClearQueue(blocked);
+    for (ProcessGroup &group : groups)
+    {
+        ClearQueue(group.ready);
+    }
+}
 
-void InitializeQueue(Queue &queue)
+bool Scheduler::ValidPolicy(const std::string &policy)
 {
-    queue.head = nullptr;
-    queue.tail = nullptr;
+    return policy == "FCFS" || policy == "SJF" || policy == "RR" || policy == "PRIO" || policy == "FAIR";
 }
 
-std::string policy;
-std::string inputFilename;
-int PROCESS_NUM;
-int quantum = -1;
-ProcessProfile* currentProcessPtr = nullptr;
-Queue *globalQueuePtr;
-pid_t currentPID;
-bool flag = false;
-
-// ----------------------------------   FUNCTIONS   --------------------------------------
-
-//***********************************     adding and removing process from the queue    ****************************************
-
-void DeleteProcess(Queue &queue, pid_t pidToDelete)
+bool Scheduler::ValidInnerPolicy(const std::string &policy)
 {
-    Node *current = queue.head;
+    return policy == "RR" || policy == "SJF" || policy == "PRIO";
+}
 
-    while (current != nullptr)
+void Scheduler::SetInnerPolicy(const std::string &innerPolicy)
+{
+    if (policy == "FAIR")
     {
-        if (current->processDescription.pid == pidToDelete)
-        {
-            // found the process with the specified PID, remove it from the queue
-            if (current->prev != nullptr)
-            {
-                current->prev->next = current->next;
-           }
-            else
-            {
-              
-                queue.head = current->next;
-           }
+        this->innerPolicy = innerPolicy;
+    }
+}
 
-            if (current->next != nullptr)
-            {
-                current->next->prev = current->prev;
-           }
-            else
-            {
-                
-                queue.tail = current->prev;
-           }
+void Scheduler::SetAdaptiveQuantum(double percentile, size_t window)
+{
+    adaptivePercentile = percentile;
+    adaptiveWindow = window > 0 ? window : 1;
+    recentBursts.clear();
+    recentNext = 0;
+}
 
-            delete current; 
+// the burst lengths replace the oldest entry of the window, then the quantum follows the percentile
+void Scheduler::ObserveBurst(double length)
+{
+    if (adaptivePercentile <= 0)
+    {
+        return;
+    }
 
-            return;
-       }
+    if (recentBursts.size() < adaptiveWindow)
+    {
+        recentBursts.push_back(length);
+    }
+    else
+    {
+        recentBursts[recentNext] = length;
+    }
+    recentNext = (recentNext + 1) % adaptiveWindow;
 
-        current = current->next;
-   }
+    std::vector<double> sorted(recentBursts);
+    size_t rank = (size_t)(adaptivePercentile / 100 * sorted.size());
+    if (rank > 0)
+    {
+        rank--;
+    }
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
 
-    // if the process with the specified PID was not found in the queue
-    std::cerr << "Process with PID " << pidToDelete << " not found in the queue." << std::endl;
+    // with a quantum far above the switch cost, switching stays a small share of the CPU time
+    double minimum = std::max(kMinAdaptiveQuantum, kMinQuantumPerSwitch * switchCost);
+    quantum = std::max(sorted[rank], minimum);
 }
 
-void AddProcess(Queue &queue, const ProcessProfile &process)
+void Scheduler::SetGroupWeight(const std::string &group, double weight)
 {
-    // create a new node for the new process
-    Node *newNode = new Node;
+    groupWeights[group] = weight;
 
-    if (newNode == nullptr)
+    std::unordered_map<std::string, int>::iterator found = groupIndex.find(group);
+    if (found != groupIndex.end())
     {
-       std::cout << "Error: Memory allocation failed ." << std::endl;
-        exit(1);
-   }
-
-    // initialize the new node
-    newNode->processDescription = process;
-    newNode->prev = nullptr;
-    newNode->next = nullptr;
+        groups[found->second].stats.weight = weight;
+    }
+}
 
-    if (queue.head == nullptr)
-    {
-        // if the queue is empty, initialize the first node
-        queue.head = newNode;
-        queue.tail = newNode;
-   }
-    else
+std::vector<GroupStats> Scheduler::GroupStatistics() const
+{
+    std::vector<GroupStats> result;
+    for (const ProcessGroup &group : groups)
     {
-        // add  new node
-        newNode->prev = queue.tail;
-        queue.tail->next = newNode;
-        queue.tail = newNode;
-   }
+        result.push_back(group.stats);
+    }
+    return result;
 }
 
-// *************************  parse the arguments from the command line  ********************************
-
-bool ParseArguments(int argc, char *argv[])
+void Scheduler::Submit(const ProcessProfile &process)
 {
-    if (argc < 3 || argc > 4)
-    {
-       std::cout << "Wrong Format!" << std::endl;
-        return false;
-   }
+    ProcessProfile submitted = process;
+    submitted.id = nextId++;
+    submitted.groupIndex = GroupFor(process.group);
 
-    policy = argv[1];
+    stats.processCount++;
+    groups[submitted.groupIndex].stats.processCount++;
 
-    inputFilename = argv[argc - 1];
-    quantum = -1;
+    // arrivals that are due go straight through admission, in submission order
+    arrivals.insert(std::make_pair(submitted.arrivalTime, submitted));
+    AdmitArrivals(stats.time);
+}
 
-    if (argc == 4)
-    {
-        if ((policy == "RR" || policy == "PRIO"))
-        {
-            int quantum_milliseconds = std::stoi(argv[2]); // convert to integer
-            quantum = quantum_milliseconds / 1000;
-            if (quantum <= 0)
-            {
-               std::cout << "Quantum value is missing!" << std::endl;
-                return false;
-           }
-       }
-        else
-        {
-           std::cout << "Only RR or PRIO require quantum" << std::endl;
-            return false;
-       }
-   }
+// ----------------------------------   ADMISSION CONTROL   --------------------------------------
 
-    return true;
+bool Scheduler::ValidAdmissionAction(const std::string &action)
+{
+    return action == "reject" || action == "defer" || action == "deprioritize";
 }
 
-// ************************ insert the process from the input file to queue  ***************************
-void InsertProcessQueue(Queue &queue, const std::string &inputFilename)
+void Scheduler::AdmitArrivals(double until)
 {
-    std::ifstream inputFile(inputFilename);
-    if (!inputFile.is_open())
+    while (!arrivals.empty() && arrivals.begin()->first <= until)
     {
-       std::cout << "Error opening input file." << std::endl;
-        return;
-   }
+        double arrival = arrivals.begin()->first;
+        ProcessProfile process = arrivals.begin()->second;
+        arrivals.erase(arrivals.begin());
+        Arrive(process, arrival);
+    }
+}
 
-    std::string line;
-    while (std::getline(inputFile, line))
+// the process reaches the ready queue unless admission control turns it away or postpones it
+void Scheduler::Arrive(ProcessProfile &process, double arrival)
+{
+    if (!admission.action.empty() && Overloaded(process))
     {
-        PROCESS_NUM++;
-
-        std::istringstream iss(line);
-        std::string process_name;
-        int prior;
-        int bursttime;
+        if (admission.action == "defer" && admission.deferDelay > 0 && process.deferrals < admission.maxDeferrals)
+        {
+            process.deferrals++;
+            stats.deferrals++;
+            arrivals.insert(std::make_pair(arrival + admission.deferDelay, process));
+            return;
+        }
 
-        if (iss >> process_name >> prior >> bursttime)
+        if (admission.action == "deprioritize")
         {
-            ProcessProfile process;
-            process.name = process_name;
-            process.pid = -1;
-            process.status = ImplementationStatus::READY;
-            process.priority = prior;
-            process.burst_time = bursttime;
-            process.turnaround_time = 0;
-            process.total_waiting_time = 0;
-            process.remain_time = process.burst_time;
+            // behind every regular process, deprioritized ones take turns among themselves
+            process.priority = INT_MAX;
+            stats.deprioritized++;
+        }
+        else
+        {
+            stats.rejected++;
+            if (log != nullptr)
+            {
+                *log << "Rejected process " << process.name << " at time " << arrival << " seconds\n";
+            }
+            return;
+        }
+    }
 
-            AddProcess(queue, process);
-       }
-   }
+    stats.admitted++;
 
-    inputFile.close();
+    Node *node = new Node;
+    node->processDescription = process;
+    // a postponed process only counts as waiting from the attempt that got it in
+    node->processDescription.readySince = arrival;
+    node->prev = nullptr;
+    node->next = nullptr;
+    MakeReady(node);
 
-}
-//   others 
-void SetCurrentProcess(ProcessProfile& process) {
-    if (currentProcessPtr == nullptr) {
-        currentProcessPtr = &process;
-     //   std::cout << "currentProcessPtr is now pointing to PID: " << process.pid << std::endl;
-    } else {
-        std::cout<<"NULL PTR\n";
+    if (executor != nullptr && !executor->Admit(node->processDescription))
+    {
+        Fail(node);
     }
 }
 
-void ProcessInfo(ProcessProfile &process)
+bool Scheduler::Overloaded(const ProcessProfile &process) const
 {
-    std::cout << "-----------------------------------------\n" << flush;
-    std::cout << "| Process name: " << process.name << "           |\n";
-    std::cout << "| Process id: " << process.pid << "                      |\n";
-    std::cout << "| Start Time: " << process.startTime << "    seconds              |\n";
-    std::cout << "| End Time: " << process.endTime << "         seconds           |\n";
-    std::cout << "| Burst Time: " << process.burst_time << "     seconds             |\n";
-    std::cout << "| Remaining Time: " << process.remain_time << "     seconds             |\n";
-    std::cout << "| Turnaround Time: " << process.turnaround_time << " seconds            |\n";
-    std::cout << "| Waiting Time: " << process.total_waiting_time << " seconds               |\n";
-    std::cout << "-----------------------------------------\n";
-
+    if (admission.maxReadyDepth > 0 && readyCount >= admission.maxReadyDepth)
+    {
+        return true;
+    }
+    return admission.maxPredictedWait > 0 && PredictWait(process) > admission.maxPredictedWait;
 }
 
-void TerminationHandler(int signo)
+// walks the queue the process would join, so the estimate costs O(ready processes)
+double Scheduler::PredictWait(const ProcessProfile &process) const
 {
+    const Queue &ready = ReadyQueueOf(process);
+    double burst = process.bursts[process.burstIndex];
+    bool sliced = (innerPolicy == "RR" || innerPolicy == "PRIO") && quantum > 0;
 
-    if (currentPID > 0  )
-    { 
-        if(kill(currentPID,SIGCHLD)== 0)
-         {
-            std::cout << "Termination Handler called." << std::endl;
-            currentProcessPtr->status = ImplementationStatus::EXITED;
-            std::cout << "TerminationHandler: Process with PID " << currentPID << " has terminated.\n";
-
-            ProcessInfo(*currentProcessPtr);
-            DeleteProcess(*globalQueuePtr, currentProcessPtr->pid);}
-                
-           }
-            
-       
-}
+    double wait = 0;
+    int ahead = 0;
+    for (Node *node = ready.head; node != nullptr; node = node->next)
+    {
+        const ProcessProfile &other = node->processDescription;
+        double work = 0;
 
-void ContinueHandler(int signum) {
-    if (currentPID > 0) {
-        std::cout << "Continue Handler called." << std::endl << std::flush;
-        if (kill(currentPID, SIGCONT) == 0) { 
-            std::cout << "Process with PID " << currentPID << " has been resumed in " << currentProcessPtr->endTime<<" seconds ."<<std::endl << std::flush;
-            currentProcessPtr->status = ImplementationStatus::RUNNING;
-        } else {
-            std::cerr << "Error stopping process with PID " << currentPID << ". Errno: " << errno << std::endl << std::flush;
+        if (innerPolicy == "SJF")
+        {
+            // only shorter bursts run first
+            work = other.burstRemaining <= burst ? other.burstRemaining : 0;
         }
-    }
-}
-
-int CalculateExecutionTime(int quantum, int remain_time) {
-    int executionTime;
-     if (quantum > remain_time)
+        else if (innerPolicy == "PRIO" && other.priority != process.priority)
         {
-           executionTime = remain_time;
+            // higher priorities run to the end of their burst, lower ones not at all
+            work = other.priority < process.priority ? other.burstRemaining : 0;
+        }
+        else if (sliced)
+        {
+            // RR, and equal priorities under PRIO: every process ahead runs one slice
+            work = std::min(other.burstRemaining, quantum);
         }
         else
-        {       
-            executionTime = quantum;
+        {
+            work = other.burstRemaining;
         }
-    
-    return executionTime;
-}
 
-void StopHandler(int signum) {
-    
-    if (currentPID > 0 && flag == true) {
-        
-        if (kill(currentPID, SIGTSTP) == 0) {
-            std::cout << "Stop Handler called." << std::endl << std::flush;
-            std::cout << "Process with PID " << currentPID<< " has been stopped in " <<currentProcessPtr->endTime<<" seconds ."<< std::endl << std::flush;
-            currentProcessPtr->status = ImplementationStatus::STOPPED;}
-          //  std::cout<<currentProcessPtr->status<<"\n";}
-            else
-            {
-            std::cerr << "Error stopping process with PID " << currentPID << ". Errno: " << errno << std::endl << std::flush;}
+        if (work > 0)
+        {
+            wait += work;
+            ahead++;
+        }
+    }
+    wait += ahead * switchCost;
+
+    if (policy == "FAIR")
+    {
+        // the group only gets its share of the CPU while the other active groups have work
+        const ProcessGroup &group = groups[process.groupIndex];
+        double totalWeight = EmptyQueue(group.ready) ? group.stats.weight : 0;
+        for (const std::pair<double, int> &active : activeGroups)
+        {
+            totalWeight += groups[active.second].stats.weight;
         }
+        wait *= totalWeight / group.stats.weight;
+    }
 
+    return wait;
 }
-/*
-void TerminationHandler(int signo)
+
+double Scheduler::TurnaroundPercentile(double fraction) const
 {
+    return LatencyPercentile(turnaroundBuckets, kTurnaroundBuckets, fraction, shortestTurnaround, longestTurnaround);
+}
 
-   std::cout << "Termination Handler called." << std::endl;
-    if (globalQueuePtr == nullptr)
+void Scheduler::SetExecutor(Executor *executor)
+{
+    this->executor = executor;
+    if (executor == nullptr)
     {
-       std::cout << "globalQueuePtr is null!" << std::endl;
         return;
-   }
-    Queue &queue = *globalQueuePtr;
-    Node *process = queue.head;
+    }
 
-    if (currentPID > 0)
+    // refused processes are failed once every queue has been walked
+    std::vector<Node *> refused;
+    for (Node *node = queue.head; node != nullptr; node = node->next)
+    {
+        if (!executor->Admit(node->processDescription))
+        {
+            refused.push_back(node);
+        }
+    }
+    for (ProcessGroup &group : groups)
     {
-        while (process != nullptr)
+        for (Node *node = group.ready.head; node != nullptr; node = node->next)
         {
-            if (process->processDescription.pid == currentPID)
+            if (!executor->Admit(node->processDescription))
             {
-                process->processDescription.status = ImplementationStatus::EXITED;
-                ProcessInfo(process->processDescription);
-                DeleteProcess(*globalQueuePtr, currentPID);
+                refused.push_back(node);
+            }
+        }
+    }
+    for (Node *node = blocked.head; node != nullptr; node = node->next)
+    {
+        if (!executor->Admit(node->processDescription))
+        {
+            refused.push_back(node);
+        }
+    }
 
-                std::cout << "TerminationHandler: Process with PID " << currentPID << " has terminated.\n";
-                
-                break;
-           }
-            process = process->next;
-       }
-   }
-    else
+    for (Node *node : refused)
     {
-        // Error occurred (pid < 0)
-        std::cerr << "TerminationHandler: Error in waitpid. Errno: " << errno << "\n";
-   }
-}*/
+        Fail(node);
+    }
+}
 
-void PrintStats(double totalWaitTime, double totalTurnaroundTime)
+void Scheduler::SetMetrics(SchedulerMetrics *metrics)
 {
+    this->metrics = metrics;
+    if (metrics == nullptr)
+    {
+        return;
+    }
 
-    double averageWaitTime = totalWaitTime / PROCESS_NUM;
-    double averageTurnaroundTime = totalTurnaroundTime / PROCESS_NUM;
-
-   std::cout << "\nAverage Waiting Time: " << averageWaitTime<<" seconds";
-   std::cout << "\nAverage Turnaround Time: " << averageTurnaroundTime<<" seconds" ;
-   std::cout << "\n";
+    // publish what is already queued, from here on every move is counted as it happens
+    for (ProcessGroup &group : groups)
+    {
+        group.metricsSlot = metrics->AddGroup(group.stats.name);
+    }
+    for (Node *node = queue.head; node != nullptr; node = node->next)
+    {
+        metrics->ReadyChanged(groups[node->processDescription.groupIndex].metricsSlot, 1);
+    }
+    for (ProcessGroup &group : groups)
+    {
+        for (Node *node = group.ready.head; node != nullptr; node = node->next)
+        {
+            metrics->ReadyChanged(group.metricsSlot, 1);
+        }
+    }
+    for (Node *node = blocked.head; node != nullptr; node = node->next)
+    {
+        metrics->BlockedChanged(1);
+    }
+    metrics->ClockAdvanced(stats.time, stats.cpuBusyTime);
 }
 
-bool EmptyQueue(const Queue &queue)
+void Scheduler::Submit(const std::string &name, int priority, double burstTime)
 {
-    return queue.head == nullptr;
+    Submit(MakeProcess(name, priority, burstTime));
 }
 
-Node *ShortestProcess(const Queue &queue)
+// ************************ insert the process from the input file to queue  ***************************
+int Scheduler::LoadFile(const std::string &filename)
 {
-    Node *shortest = nullptr;
-    Node *process = queue.head;
-
-    while (process != nullptr)
-    {
-        if (shortest == nullptr || process->processDescription.burst_time < shortest->processDescription.burst_time)
-        {
-            shortest = process;
-       }
-
-        process = process->next; // Move to the next process in the queue
-   }
-
-    return shortest;
+    return ReadProcessFile(filename, [this](const ProcessProfile &process) { Submit(process); });
 }
 
-int CountProcesses(const Queue &queue)
+// pick the node the policy wants to run next, it stays linked in the queue
+Node *Scheduler::SelectNext()
 {
-    int count = 0;
-    Node *process = queue.head;
-
-    while (process != nullptr)
+    if (policy == "FAIR")
     {
-        count++;
-   }
+        // the group that received the least CPU time for its weight goes next
+        std::pair<double, int> next = *activeGroups.begin();
+        fairClock = next.first;
+        return SelectFrom(groups[next.second].ready);
+    }
 
-    return count;
+    return SelectFrom(queue);
 }
 
-void SimulateProcess(ProcessProfile &process, int sleep_time)
+Node *Scheduler::SelectFrom(const Queue &ready) const
 {
-    if (sleep_time > 0)
+    if (innerPolicy == "SJF")
     {
-        std::cout << "Executing process: " << process.name << " for " << sleep_time << " seconds." << std::endl;
-        sleep(sleep_time);
-
+        return ShortestProcess(ready);
     }
-    else
+    if (innerPolicy == "PRIO")
     {
-       std::cout << "Executing process: " << process.name << " for " << process.burst_time << " seconds." << std::endl;
-        sleep(process.burst_time);
-       std::cout << "Process " << process.name << " completed." << std::endl;
-   }
-}
-/*
-void  ContinueHandler(int signum){
-    std::cout << "Continue Handler called." << std::endl;
-    if (globalQueuePtr == nullptr)
-    {
-       std::cout << "globalQueuePtr is null!" << std::endl;
-          return;
+        // preempted processes go to the tail, so equal priorities take turns
+        return HighestPriority(ready);
     }
-    Queue &queue = *globalQueuePtr;
-    Node *process = queue.head;
 
+    // FCFS runs the head to completion, RR rotates the head to the tail after each slice
+    return ready.head;
+}
 
-    if ( currentPID > 0)
+// a slice never runs past the end of the current CPU burst
+double Scheduler::SliceFor(const ProcessProfile &process) const
+{
+    if ((innerPolicy == "RR" || innerPolicy == "PRIO") && quantum > 0)
     {
-        while (process != nullptr)
+        // a leftover within rounding distance of the quantum is folded into this slice
+        if (process.burstRemaining <= quantum + kTimeEpsilon)
         {
-            if (process->processDescription.pid == currentPID && process->processDescription.status == ImplementationStatus::STOPPED )
-            {
-                process->processDescription.status = ImplementationStatus::RUNNING;
-                std::cout << "Process with PID " << process->processDescription.pid << " has been resumed in " << process->processDescription.endTime << " seconds." << std::endl;
-                break; // Stop the first running process found
-           }    
-            process = process->next;
-       }
-   }
-    else
-    {
-        // Error occurred (pid < 0)
-        std::cerr << " ContinueHandler: Error in waitpid. Errno: " << errno << endl;
+            return process.burstRemaining;
+        }
+        return CalculateExecutionTime(quantum, process.burstRemaining);
     }
 
+    return process.burstRemaining;
 }
 
+bool Scheduler::Step()
+{
+    AdmitArrivals(stats.time);
+
+    if (ReadyEmpty())
+    {
+        if (EmptyQueue(blocked) && arrivals.empty())
+        {
+            return false;
+        }
+
+        // the CPU idles until the device serves the next process or the next one arrives
+        double wakeUp = arrivals.empty() ? NextIoCompletion() : arrivals.begin()->first;
+        if (!EmptyQueue(blocked))
+        {
+            wakeUp = std::min(wakeUp, NextIoCompletion());
+        }
+        if (executor != nullptr)
+        {
+            executor->Idle(wakeUp - stats.time);
+        }
+        stats.time = wakeUp;
+        // idle time lowers the utilization the metrics report
+        if (metrics != nullptr)
+        {
+            metrics->ClockAdvanced(stats.time, stats.cpuBusyTime);
+        }
+        ServiceDevice(stats.time);
+        AdmitArrivals(stats.time);
+
+        // the arrivals may all have been turned away
+        if (ReadyEmpty())
+        {
+            return true;
+        }
+    }
 
+    Node *node = SelectNext();
+    ProcessProfile &currentProcess = node->processDescription;
 
-void  StopHandler(int signum){
-    
-  if (currentPID > 0 )
-  {  
-    std::cout << "Stop Handler called." << std::endl;
-    if (globalQueuePtr == nullptr)
+    // switching to another process costs clock time before the slice starts, the device keeps working meanwhile
+    bool switched = currentProcess.id != lastDispatched;
+    if (switched)
     {
-       std::cout << "globalQueuePtr is null!" << std::endl;
-          return;
+        stats.contextSwitches++;
+        stats.switchTime += switchCost;
+        stats.time += switchCost;
+        lastDispatched = currentProcess.id;
+        ServiceDevice(stats.time);
     }
-    Queue &queue = *globalQueuePtr;
-    Node *process = queue.head;
 
-    
-        while (process != nullptr)
-        {
-            if (process->processDescription.pid == currentPID && process->processDescription.status == ImplementationStatus::RUNNING)
-            {
-               process->processDescription.status = ImplementationStatus::STOPPED;
-                std::cout << "Process with PID " << process->processDescription.pid << " has been stopped in " << process->processDescription.endTime << " seconds." << std::endl;
-                break; // Stop the first running process found
-           }    
-            process = process->next;
-       }
-   }
+    if (currentProcess.status == ImplementationStatus::READY)
+    {
+        currentProcess.startTime = stats.time;
+    }
+    currentProcess.total_waiting_time += stats.time - currentProcess.readySince;
 
-}
-*/
+    double executionTime = SliceFor(currentProcess);
+    currentProcess.status = ImplementationStatus::RUNNING;
 
-pid_t ForkChild(const ProcessProfile &currentProcess)
-{
-    pid_t pid = fork();
+    bool alive = true;
+    if (executor != nullptr && metrics != nullptr)
+    {
+        // how far the real slice ran past the planned one
+        std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+        alive = executor->Dispatch(currentProcess, executionTime);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - before).count();
+        metrics->SliceOvershoot(elapsed > executionTime ? elapsed - executionTime : 0);
+    }
+    else if (executor != nullptr)
+    {
+        alive = executor->Dispatch(currentProcess, executionTime);
+    }
 
-   if (pid == -1)
+    // a process that died is not dispatched again and its slice is not charged
+    if (!alive)
     {
-       
-        std::cout << "Fork failed for process " << currentProcess.name << std::endl;
-        exit(1); 
+        Fail(node);
+        return true;
     }
-    else if (pid == 0)
+
+    stats.dispatches++;
+    stats.time += executionTime;
+    stats.cpuBusyTime += executionTime;
+    currentProcess.remain_time -= executionTime;
+    currentProcess.burstRemaining -= executionTime;
+    ChargeGroup(currentProcess, executionTime);
+    if (metrics != nullptr)
     {
-        // child Process
-        return 0; 
+        metrics->Dispatched(switched);
+        metrics->ClockAdvanced(stats.time, stats.cpuBusyTime);
+    }
+
+    // requests the device finished and arrivals that came in meanwhile queue up ahead of the preempted process
+    ServiceDevice(stats.time);
+    AdmitArrivals(stats.time);
+
+    if (currentProcess.burstRemaining <= kTimeEpsilon)
+    {
+        ObserveBurst(currentProcess.bursts[currentProcess.burstIndex]);
+
+        // the burst structure decides, the running totals may carry rounding errors
+        if (currentProcess.burstIndex + 1 >= (int)currentProcess.bursts.size())
+        {
+            Finish(node);
+        }
+        else
+        {
+            StartIo(node);
+        }
     }
     else
     {
-        // parent Process
-        return pid; //
+        currentProcess.status = ImplementationStatus::STOPPED;
+        currentProcess.readySince = stats.time;
+        RemoveReady(node);
+        MakeReady(node);
+        if (metrics != nullptr)
+        {
+            metrics->Preempted();
+        }
     }
-    return pid;
-}
 
+    return true;
+}
 
+// ----------------------------------   GROUPS   --------------------------------------
 
-void ChildExecutionSimulation(ProcessProfile &currentProcess, int sleep_time)
+int Scheduler::GroupFor(const std::string &name)
 {
-    
-    std::cout << "Child process started. PID: " << getpid() << std::endl;
-    // Simulate the process execution
-    SimulateProcess(currentProcess, sleep_time);
-    std::cout << "Child process with PID " << getpid() << " completed." << std::endl;
+    std::unordered_map<std::string, int>::iterator found = groupIndex.find(name);
+    if (found != groupIndex.end())
+    {
+        return found->second;
+    }
 
-    exit(0);
-    
+    ProcessGroup group;
+    group.stats.name = name;
+    std::unordered_map<std::string, double>::iterator weight = groupWeights.find(name);
+    group.stats.weight = weight != groupWeights.end() ? weight->second : 1;
+    group.stats.processCount = 0;
+    group.stats.completed = 0;
+    group.stats.totalWaitingTime = 0;
+    group.stats.totalTurnaroundTime = 0;
+    group.stats.cpuTime = 0;
+    group.virtualTime = fairClock;
+    InitializeQueue(group.ready);
+    group.metricsSlot = metrics != nullptr ? metrics->AddGroup(name) : -1;
+
+    groups.push_back(group);
+    groupIndex[name] = (int)groups.size() - 1;
+    return (int)groups.size() - 1;
 }
 
-void ParentWaitChld(ProcessProfile &currentProcess,int var)
+// FAIR keeps one ready queue per group, every other policy shares a single one
+Queue &Scheduler::ReadyQueueOf(const ProcessProfile &process)
 {
-    int status;
-    
-    if( var > 1)
+    if (policy == "FAIR")
     {
-        std::cout << "Parent process with the child process with PID  " << currentProcess.pid << std::endl;
-        // Wait for the child process to finish
-        waitpid(currentProcess.pid, &status, 0);
+        return groups[process.groupIndex].ready;
     }
-    if (var == 0 )
+    return queue;
+}
+
+const Queue &Scheduler::ReadyQueueOf(const ProcessProfile &process) const
+{
+    if (policy == "FAIR")
     {
-    std::cout << "Parent process has forked a child process with PID and waits  " << currentProcess.pid << " to finish..." <<std::endl;
-    // Wait for the child process to finish
-    waitpid(currentProcess.pid, &status, 0);
-    std::cout << "Parent process finished waiting for child process with PID " << currentProcess.pid << "." << std::endl;
+        return groups[process.groupIndex].ready;
     }
-    if (WIFEXITED(status))
-    {
-        printf("Child exited with status of %d.\n\n", WEXITSTATUS(status));
-        sleep(2);
-   }
-    else if (WIFSIGNALED(status))
-    {
-        printf("Child was interrupt by signal %d.\n\n", WTERMSIG(status));
-        sleep(2);
-   }
-    else if (WIFSTOPPED(status))
-    {
-        printf("Child was stopped by signal %d.\n\n", WSTOPSIG(status));
-        sleep(2);
-   }
-    else
+    return queue;
+}
+
+void Scheduler::MakeReady(Node *node)
+{
+    Queue &ready = ReadyQueueOf(node->processDescription);
+
+    if (policy == "FAIR" && EmptyQueue(ready))
     {
-        puts("Reason unknown for child termination.");
-   }
-    
+        // a group that had nothing to run does not bank CPU time for later
+        ProcessGroup &group = groups[node->processDescription.groupIndex];
+        if (group.virtualTime < fairClock)
+        {
+            group.virtualTime = fairClock;
+        }
+        activeGroups.insert(std::make_pair(group.virtualTime, node->processDescription.groupIndex));
+    }
 
+    AppendNode(ready, node);
+    readyCount++;
+    if (metrics != nullptr)
+    {
+        metrics->ReadyChanged(groups[node->processDescription.groupIndex].metricsSlot, 1);
+    }
 }
 
-// update times
+void Scheduler::RemoveReady(Node *node)
+{
+    Queue &ready = ReadyQueueOf(node->processDescription);
+    UnlinkNode(ready, node);
+    readyCount--;
+    if (metrics != nullptr)
+    {
+        metrics->ReadyChanged(groups[node->processDescription.groupIndex].metricsSlot, -1);
+    }
 
-void updateTimesRRPRIO(ProcessProfile &currentProcess, int &executionTime, int &time) {
-    
-    currentProcess.endTime = time + executionTime;
-    currentProcess.turnaround_time = currentProcess.endTime - currentProcess.startTime;
-    currentProcess.total_waiting_time = currentProcess.turnaround_time - currentProcess.burst_time;
+    if (policy == "FAIR" && EmptyQueue(ready))
+    {
+        int index = node->processDescription.groupIndex;
+        activeGroups.erase(std::make_pair(groups[index].virtualTime, index));
+    }
 }
 
+bool Scheduler::ReadyEmpty() const
+{
+    if (policy == "FAIR")
+    {
+        return activeGroups.empty();
+    }
+    return EmptyQueue(queue);
+}
 
-// update times
-void UpdateTimesFCSJ(ProcessProfile &currentProcess)
+void Scheduler::ChargeGroup(const ProcessProfile &process, double executionTime)
 {
-    
-    currentProcess.endTime = currentProcess.burst_time + currentProcess.startTime;
+    int index = process.groupIndex;
+    ProcessGroup &group = groups[index];
+    group.stats.cpuTime += executionTime;
 
+    if (policy == "FAIR")
+    {
+        // the running process is still queued, so the group is in the set
+        activeGroups.erase(std::make_pair(group.virtualTime, index));
+        group.virtualTime += executionTime / group.stats.weight;
+        activeGroups.insert(std::make_pair(group.virtualTime, index));
+    }
+}
 
-    double turnaroundTime = double(currentProcess.endTime - currentProcess.startTime);
-    currentProcess.turnaround_time = turnaroundTime;
+// ----------------------------------   CHECKPOINTS   --------------------------------------
 
-   
-    currentProcess.total_waiting_time = currentProcess.startTime;
-    currentProcess.remain_time -= currentProcess.burst_time;
+SchedulerConfig Scheduler::Config() const
+{
+    SchedulerConfig config = DefaultSchedulerConfig(policy, quantum);
+    config.switchCost = switchCost;
+    config.innerPolicy = policy == "FAIR" ? innerPolicy : "";
+    config.groupWeights.assign(groupWeights.begin(), groupWeights.end());
+    // sorted, so the same state always gives the same file
+    std::sort(config.groupWeights.begin(), config.groupWeights.end());
+    config.adaptivePercentile = adaptivePercentile;
+    config.adaptiveWindow = adaptiveWindow;
+    config.admission = admission;
+    return config;
 }
 
-// function to handle process termination or send SIGSTOP signal
-void TerminateOrStop(ProcessProfile &currentProcess) {
-    std::cout<<currentProcess.remain_time<<endl;
-    if (currentProcess.remain_time == 0) {
-        ParentWaitChld(currentProcess,0);
-        exit(0);
-   } else {
-        
-     kill(currentProcess.pid, SIGTSTP);
-   }
+void Scheduler::SetCheckpointing(const std::string &filename, int everyDispatches)
+{
+    checkpointFile = filename;
+    checkpointEvery = everyDispatches;
+    // a resumed run keeps saving at the same multiples
+    lastCheckpoint = everyDispatches > 0 ? stats.dispatches - stats.dispatches % everyDispatches : 0;
 }
 
-
-// ------------------------ POLICIES -----------------------
-
-void FCFS(Queue &queue)
+bool Scheduler::SaveCheckpoint(const std::string &filename) const
 {
-    double totalWaitTime;
-    double totalTurnaroundTime;
-    int time = 0;
+    CheckpointWriter writer;
+    writer.PutConfig(Config());
+
+    writer.PutInt(nextId);
+    writer.PutInt(lastDispatched);
+    writer.PutDouble(fairClock);
+    writer.PutDouble(deviceFreeAt);
+
+    writer.PutInt(stats.processCount);
+    writer.PutInt(stats.completed);
+    writer.PutInt(stats.dispatches);
+    writer.PutDouble(stats.totalWaitingTime);
+    writer.PutDouble(stats.totalTurnaroundTime);
+    writer.PutDouble(stats.time);
+    writer.PutDouble(stats.cpuBusyTime);
+    writer.PutDouble(stats.deviceBusyTime);
+    writer.PutInt(stats.contextSwitches);
+    writer.PutDouble(stats.switchTime);
+    writer.PutInt(stats.admitted);
+    writer.PutInt(stats.rejected);
+    writer.PutInt(stats.deferrals);
+    writer.PutInt(stats.deprioritized);
+    writer.PutDouble(shortestTurnaround);
+    writer.PutDouble(longestTurnaround);
+    // only the buckets in use, as index and count pairs
+    int64_t usedBuckets = 0;
+    for (int i = 0; i < kTurnaroundBuckets; i++)
+    {
+        usedBuckets += turnaroundBuckets[i] > 0;
+    }
+    writer.PutInt(usedBuckets);
+    for (int i = 0; i < kTurnaroundBuckets; i++)
+    {
+        if (turnaroundBuckets[i] > 0)
+        {
+            writer.PutInt(i);
+            writer.PutInt(turnaroundBuckets[i]);
+        }
+    }
 
-    std::cout << "#####################   FCFS POLICY: INFORMATION ABOUT EACH PROCESS  ##################### \n\n";
+    // the adaptive quantum itself is saved with the config, its window here
+    writer.PutInt((int64_t)recentBursts.size());
+    for (double burst : recentBursts)
+    {
+        writer.PutDouble(burst);
+    }
+    writer.PutInt((int64_t)recentNext);
 
-    Node *process = queue.head;
+    writer.PutInt((int64_t)groups.size());
+    for (const ProcessGroup &group : groups)
+    {
+        writer.PutString(group.stats.name);
+        writer.PutInt(group.stats.processCount);
+        writer.PutInt(group.stats.completed);
+        writer.PutDouble(group.stats.totalWaitingTime);
+        writer.PutDouble(group.stats.totalTurnaroundTime);
+        writer.PutDouble(group.stats.cpuTime);
+        writer.PutDouble(group.virtualTime);
+    }
 
-    while (process != nullptr)
-    { // loop through the processes in the queue
-        ProcessProfile &currentProcess = process->processDescription;
-        currentProcess.startTime = time;
-        pid_t pid = ForkChild(currentProcess);
-      //  int status;
+    // ready processes in queue order, one list per ready queue
+    std::vector<const Queue *> readyQueues;
+    if (policy == "FAIR")
+    {
+        for (const ProcessGroup &group : groups)
+        {
+            readyQueues.push_back(&group.ready);
+        }
+    }
+    else
+    {
+        readyQueues.push_back(&queue);
+    }
 
-        if (pid == 0)
-        { // child
+    writer.PutInt((int64_t)readyQueues.size());
+    for (const Queue *ready : readyQueues)
+    {
+        writer.PutInt(CountProcesses(*ready));
+        for (Node *node = ready->head; node != nullptr; node = node->next)
+        {
+            writer.PutProcess(node->processDescription);
+        }
+    }
 
-            ChildExecutionSimulation(currentProcess,0);
-       }
-        else
-        { // parent
-            currentProcess.status = ImplementationStatus::RUNNING;
-            currentProcess.pid = pid;
-            currentPID = currentProcess.pid;
+    writer.PutInt(CountProcesses(blocked));
+    for (Node *node = blocked.head; node != nullptr; node = node->next)
+    {
+        writer.PutProcess(node->processDescription);
+    }
 
-            UpdateTimesFCSJ(currentProcess);
-            ParentWaitChld(currentProcess,0);
-           
-            totalWaitTime += currentProcess.total_waiting_time;
-            totalTurnaroundTime += currentProcess.turnaround_time;  
-       } 
+    // arrivals keep the time they are due, which differs from arrivalTime after a deferral
+    writer.PutInt((int64_t)arrivals.size());
+    for (const std::pair<const double, ProcessProfile> &arrival : arrivals)
+    {
+        writer.PutDouble(arrival.first);
+        writer.PutProcess(arrival.second);
+    }
 
-            time += currentProcess.burst_time;
-            process = process->next; 
-           
-   }
-    PrintStats(totalWaitTime, totalTurnaroundTime);
+    return writer.WriteFile(filename);
 }
 
-// SJF policy
-void SJF(Queue &queue)
+bool Scheduler::RestoreCheckpoint(const std::string &filename)
 {
-    double totalWaitTime = 0;
-    double totalTurnaroundTime = 0;
-    int time = 0;
+    CheckpointReader reader;
+    if (stats.processCount > 0 || !reader.ReadFile(filename))
+    {
+        return false;
+    }
 
-    std::cout << "#####################   SJF POLICY: INFORMATION ABOUT EACH PROCESS  ##################### \n\n";
+    // the saved settings are for ReadCheckpointConfig, this scheduler keeps its own
+    reader.GetConfig();
+
+    nextId = (int)reader.GetInt();
+    lastDispatched = (int)reader.GetInt();
+    fairClock = reader.GetDouble();
+    deviceFreeAt = reader.GetDouble();
+
+    stats.processCount = (int)reader.GetInt();
+    stats.completed = (int)reader.GetInt();
+    stats.dispatches = (int)reader.GetInt();
+    stats.totalWaitingTime = reader.GetDouble();
+    stats.totalTurnaroundTime = reader.GetDouble();
+    stats.time = reader.GetDouble();
+    stats.cpuBusyTime = reader.GetDouble();
+    stats.deviceBusyTime = reader.GetDouble();
+    stats.contextSwitches = (int)reader.GetInt();
+    stats.switchTime = reader.GetDouble();
+    stats.admitted = (int)reader.GetInt();
+    stats.rejected = (int)reader.GetInt();
+    stats.deferrals = (int)reader.GetInt();
+    stats.deprioritized = (int)reader.GetInt();
+
+    shortestTurnaround = reader.GetDouble();
+    longestTurnaround = reader.GetDouble();
+    int64_t count = reader.GetInt();
+    for (int64_t i = 0; reader.Ok() && i < count; i++)
+    {
+        int64_t bucket = reader.GetInt();
+        int64_t finished = reader.GetInt();
+        if (bucket < 0 || bucket >= kTurnaroundBuckets)
+        {
+            return false;
+        }
+        turnaroundBuckets[bucket] = finished;
+    }
 
-    Node *process = queue.head;
+    count = reader.GetInt();
+    std::vector<double> savedBursts;
+    for (int64_t i = 0; reader.Ok() && i < count; i++)
+    {
+        savedBursts.push_back(reader.GetDouble());
+    }
+    size_t savedNext = (size_t)reader.GetInt();
+    // a window of another size starts over
+    if (adaptivePercentile > 0 && savedBursts.size() <= adaptiveWindow && savedNext < adaptiveWindow)
+    {
+        recentBursts = savedBursts;
+        recentNext = savedNext;
+    }
 
-    while (!EmptyQueue(queue))
-    { // Continue until all processes are executed
-        Node *shortest = ShortestProcess(queue);
+    count = reader.GetInt();
+    for (int64_t i = 0; reader.Ok() && i < count; i++)
+    {
+        std::string name = reader.GetString();
+        ProcessGroup &group = groups[GroupFor(name)];
+        group.stats.processCount = (int)reader.GetInt();
+        group.stats.completed = (int)reader.GetInt();
+        group.stats.totalWaitingTime = reader.GetDouble();
+        group.stats.totalTurnaroundTime = reader.GetDouble();
+        group.stats.cpuTime = reader.GetDouble();
+        group.virtualTime = reader.GetDouble();
+    }
 
-        if (shortest == nullptr)
+    // the processes go through MakeReady, so they land in the queues of this scheduler's policy
+    int64_t lists = reader.GetInt();
+    for (int64_t list = 0; reader.Ok() && list < lists; list++)
+    {
+        count = reader.GetInt();
+        for (int64_t i = 0; reader.Ok() && i < count; i++)
         {
-            break; // No process found, break the loop
-       }
+            ProcessProfile process = reader.GetProcess();
+            if (!reader.Ok())
+            {
+                break;
+            }
 
-        ProcessProfile &currentProcess = shortest->processDescription;
-        currentProcess.startTime = time;
-        pid_t pid = ForkChild(currentProcess);
+            Node *node = new Node;
+            node->processDescription = process;
+            node->processDescription.groupIndex = GroupFor(process.group);
+            node->prev = nullptr;
+            node->next = nullptr;
+            MakeReady(node);
+        }
+    }
 
-        if (pid == 0)
-        {
-            ChildExecutionSimulation(currentProcess,0);
-           
-       }
-        else
+    count = reader.GetInt();
+    for (int64_t i = 0; reader.Ok() && i < count; i++)
+    {
+        ProcessProfile process = reader.GetProcess();
+        if (!reader.Ok())
         {
-           // parent
-            currentProcess.status = ImplementationStatus::RUNNING;
-            currentProcess.pid = pid;
-            currentPID = currentProcess.pid;
+            break;
+        }
 
-            UpdateTimesFCSJ(currentProcess);
-            ParentWaitChld(currentProcess,0);
-           
-            totalWaitTime += currentProcess.total_waiting_time;
-            totalTurnaroundTime += currentProcess.turnaround_time; 
-       }
+        Node *node = AddProcess(blocked, process);
+        node->processDescription.groupIndex = GroupFor(process.group);
+        if (metrics != nullptr)
+        {
+            metrics->BlockedChanged(1);
+        }
+    }
 
-        time += currentProcess.burst_time;
+    count = reader.GetInt();
+    for (int64_t i = 0; reader.Ok() && i < count; i++)
+    {
+        double due = reader.GetDouble();
+        ProcessProfile process = reader.GetProcess();
+        if (!reader.Ok())
+        {
+            break;
+        }
 
-   }
+        process.groupIndex = GroupFor(process.group);
+        arrivals.insert(std::make_pair(due, process));
+    }
 
-    // Print statistics
-    PrintStats(totalWaitTime, totalTurnaroundTime);
+    return reader.Ok();
 }
 
-void RR(Queue &queue)
+// ----------------------------------   I/O DEVICE   --------------------------------------
+
+// the CPU burst is over, the process queues for the device with its next burst
+void Scheduler::StartIo(Node *node)
 {
-    double totalTurnaroundTime = 0;
-    double totalWaitingTime = 0;
-    int time = 0;
-    int iterations = 0;
-    int executionTime;
+    ProcessProfile &currentProcess = node->processDescription;
 
-   
+    currentProcess.status = ImplementationStatus::BLOCKED;
+    currentProcess.burstIndex++;
+    currentProcess.blockedSince = stats.time;
 
-    std::cout << "##################### RR POLICY: INFORMATION ABOUT EACH PROCESS ##################### \n\n\n";
-    Node *process = queue.head;
-    
-    std::vector<ProcessProfile> Processes;
+    RemoveReady(node);
+    AppendNode(blocked, node);
+    if (metrics != nullptr)
+    {
+        metrics->BlockedChanged(1);
+    }
+}
 
-  
-while (process != nullptr  && Processes.size() < PROCESS_NUM )//first iteration
+double Scheduler::NextIoCompletion() const
 {
-        ProcessProfile &currentProcess = process->processDescription;
-        
-        executionTime = CalculateExecutionTime(quantum,currentProcess.remain_time);
+    const ProcessProfile &head = blocked.head->processDescription;
+    double serviceStart = head.blockedSince > deviceFreeAt ? head.blockedSince : deviceFreeAt;
 
-        pid_t pid = ForkChild(currentProcess);
-        if (pid == 0)
-        { 
-            currentProcess.pid = getpid();
-            SetCurrentProcess(currentProcess);
-            std::cout << "Child process started with PID: " << getpid() << std::endl;
-            SimulateProcess(currentProcess, executionTime);
-            flag = true;
-            currentProcess.remain_time -= executionTime;
-            _exit(0);
-            
-        }
-        else
-        {
-            // parent Process
-            currentProcess.status = ImplementationStatus::RUNNING;
-            currentProcess.pid = pid;
-            currentPID = currentProcess.pid;
-           
-   
-            updateTimesRRPRIO(currentProcess, executionTime, time);
-
-            totalTurnaroundTime += currentProcess.turnaround_time;
-            totalWaitingTime += currentProcess.total_waiting_time;
-
-            time += executionTime;
-           
-            if(currentProcess.remain_time > 0 && currentProcess.status == ImplementationStatus::RUNNING)
-            {
-                  
-                    kill(currentProcess.pid, SIGTSTP);
-    
-            }
-            else
-            {
-                
-                exit(0);
-            }
-      
-        }
-        Processes.push_back(currentProcess);
-        process = process->next;
-        
+    return serviceStart + head.bursts[head.burstIndex];
 }
 
-
-while (!EmptyQueue(queue))
+// moves every process whose I/O burst completed by the given time back to the ready queue
+void Scheduler::ServiceDevice(double until)
 {
-    for (size_t i = 0; i < Processes.size(); ++i)
+    while (!EmptyQueue(blocked) && NextIoCompletion() <= until)
     {
-        ProcessProfile &currentProcess = Processes[i];
+        Node *node = blocked.head;
+        ProcessProfile &currentProcess = node->processDescription;
+        double completion = NextIoCompletion();
+
+        stats.deviceBusyTime += currentProcess.bursts[currentProcess.burstIndex];
+        deviceFreeAt = completion;
 
-        if (currentProcess.status == ImplementationStatus::STOPPED)
+        currentProcess.burstIndex++;
+        currentProcess.burstRemaining = currentProcess.bursts[currentProcess.burstIndex];
+        currentProcess.status = ImplementationStatus::STOPPED;
+        currentProcess.readySince = completion;
+
+        UnlinkNode(blocked, node);
+        if (metrics != nullptr)
         {
-            // resume the process
-            if (kill(currentProcess.pid, SIGCONT) == 0)
-            {
-                std::cout << "Resumed process with PID " << currentProcess.pid << std::endl;
-                currentProcess.status = ImplementationStatus::RUNNING;
-
-                executionTime = CalculateExecutionTime(quantum,currentProcess.remain_time);
-               
-                SimulateProcess(currentProcess, executionTime);
-
-                currentProcess.remain_time -= executionTime;
-
-                if (currentProcess.remain_time > 0)
-                {
-                    // If the process still has remaining time, stop it
-                    kill(currentProcess.pid, SIGTSTP);
-                    currentProcess.status = ImplementationStatus::STOPPED;
-                }
-                else
-                {
-                    // process complete
-                
-                    exit(0);
-                }
-            }
-           
+            metrics->BlockedChanged(-1);
         }
+        MakeReady(node);
     }
 }
-    
-}
 
-Node *HighestPriority(Queue &queue) {
-    Node *highestPriority = nullptr;
-    Node *process = queue.head;
+void Scheduler::Run()
+{
+    if (log != nullptr)
+    {
+        *log << "#####################   " << policy << " POLICY: INFORMATION ABOUT EACH PROCESS  ##################### \n\n";
+    }
+
+    while (Step())
+    {
+        // a step may dispatch nothing, e.g. when every arrival of an idle wake-up is turned away
+        if (checkpointEvery == 0 || stats.dispatches - lastCheckpoint < checkpointEvery)
+        {
+            continue;
+        }
 
-    while (process != nullptr) {
-        if (highestPriority == nullptr || process->processDescription.priority < highestPriority->processDescription.priority) {
-            highestPriority = process;
+        lastCheckpoint = stats.dispatches;
+        if (!SaveCheckpoint(checkpointFile))
+        {
+            std::cerr << "Error writing checkpoint " << checkpointFile << ", checkpoints are turned off" << std::endl;
+            checkpointEvery = 0;
         }
+    }
 
-        process = process->next;
+    if (log != nullptr)
+    {
+        PrintReport(*log, *this);
     }
+}
 
-    return highestPriority;
-}            
- /*         
-// PRIO policy
-void PRIO(Queue &queue)
+// update times of a process that has used up its burst and drop it from the queue
+void Scheduler::Finish(Node *node)
 {
-    double totalWaitTime = 0;
-    double totalTurnaroundTime = 0;
-    int time = 0;
+    ProcessProfile &currentProcess = node->processDescription;
 
-    cout << "#####################   PRIO POLICY: INFORMATION ABOUT EACH PROCESS  ##################### \n\n";
+    currentProcess.remain_time = 0;
+    currentProcess.endTime = stats.time;
+    currentProcess.turnaround_time = currentProcess.endTime - currentProcess.arrivalTime;
+    currentProcess.status = ImplementationStatus::EXITED;
 
-    while (!EmptyQueue(queue))
+    if (executor != nullptr && !executor->Complete(currentProcess))
     {
-        Node *highestPriority = HighestPriority(queue); // Get the process with the highest priority
-
-        if (highestPriority == nullptr) {
-            break;
-        }
-
-        ProcessProfile &currentProcess = highestPriority->processDescription;
+        Fail(node);
+        return;
+    }
 
-        if (currentProcess.status == ImplementationStatus::READY)
-        {
-            currentProcess.startTime = time;
-            pid_t pid = ForkChild(currentProcess);
+    stats.completed++;
+    stats.totalWaitingTime += currentProcess.total_waiting_time;
+    stats.totalTurnaroundTime += currentProcess.turnaround_time;
 
-            if (pid == 0) {
-                ChildExecutionSimulation(currentProcess, 0);
-            } else {
-                // parent
-                currentProcess.status = ImplementationStatus::RUNNING;
-                currentProcess.pid = pid;
-                currentPID = currentProcess.pid;
+    GroupStats &groupStats = groups[currentProcess.groupIndex].stats;
+    groupStats.completed++;
+    groupStats.totalWaitingTime += currentProcess.total_waiting_time;
+    groupStats.totalTurnaroundTime += currentProcess.turnaround_time;
+    if (metrics != nullptr)
+    {
+        metrics->Completed(currentProcess.total_waiting_time, currentProcess.turnaround_time);
+    }
+    turnaroundBuckets[LatencyBucket(currentProcess.turnaround_time, kTurnaroundBuckets)]++;
+    if (stats.completed == 1 || currentProcess.turnaround_time < shortestTurnaround)
+    {
+        shortestTurnaround = currentProcess.turnaround_time;
+    }
+    if (stats.completed == 1 || currentProcess.turnaround_time > longestTurnaround)
+    {
+        longestTurnaround = currentProcess.turnaround_time;
+    }
 
-                // Calculate the execution time (quantum or remaining time, whichever is smaller)
-                int executionTime = std::min(quantum, currentProcess.remain_time);
+    if (log != nullptr)
+    {
+        ProcessInfo(*log, currentProcess);
+    }
+    if (onComplete)
+    {
+        onComplete(currentProcess);
+    }
 
-                SimulateProcess(currentProcess, executionTime);
+    RemoveReady(node);
+    delete node;
+}
 
-                // Update times and status
-                updateTimesRRPRIO(currentProcess, executionTime, time);
+// drop a process whose execution died or could not start; it counts as failed, not in the completion statistics
+void Scheduler::Fail(Node *node)
+{
+    ProcessProfile &currentProcess = node->processDescription;
+    bool wasBlocked = currentProcess.status == ImplementationStatus::BLOCKED;
 
-                // Check if the process is completed or needs to be stopped
-                if (currentProcess.remain_time > 0) {
-                    // Send SIGTSTP to stop the process
-                    kill(currentProcess.pid, SIGTSTP);
-                    currentProcess.status = ImplementationStatus::STOPPED;
-                    std::cout<<currentProcess.pid<<"has status "<<currentProcess.status<<"\n";
-                } else {
-                    // Process is completed, terminate it
-                    ParentWaitChld(currentProcess, 1); // Wait for the child process to finish
-                }
+    currentProcess.endTime = stats.time;
+    currentProcess.status = ImplementationStatus::FAILED;
+    stats.failed++;
 
-                totalTurnaroundTime += currentProcess.turnaround_time;
-                totalWaitTime += currentProcess.total_waiting_time;
-            }
+    if (log != nullptr)
+    {
+        *log << "Process " << currentProcess.name << " failed at time " << stats.time << " seconds\n";
+    }
+    if (onComplete)
+    {
+        onComplete(currentProcess);
+    }
 
-            time += executionTime;
+    if (wasBlocked)
+    {
+        UnlinkNode(blocked, node);
+        if (metrics != nullptr)
+        {
+            metrics->BlockedChanged(-1);
         }
     }
-
-    // Print statistics
-    PrintStats(totalWaitTime, totalTurnaroundTime);
+    else
+    {
+        RemoveReady(node);
+    }
+    delete node;
 }
 
-*/
-// ******************************************   main   ******************************************
+SchedulerStats Scheduler::Stats() const
+{
+    return stats;
+}
 
-int main(int argc, char *argv[])
+bool Scheduler::Idle() const
 {
-   std::cout << "------------------------------- WELCOME TO THE CPU SCHEDULER --------------------------------------\n\n\n";
+    return ReadyEmpty() && EmptyQueue(blocked) && arrivals.empty();
+}
 
-    // first take the commant line arguments from the user
-    if (!ParseArguments(argc, argv))
+void Scheduler::AdvanceClock(double time)
+{
+    // the clock never goes back, an idle CPU simply jumps to the given time
+    if (time > stats.time)
     {
-        return 1;
-   }
+        stats.time = time;
+    }
+}
 
-    // initialize the queue
-    Queue queue;
-    InitializeQueue(queue);
+// ----------------------------------   HELPERS   --------------------------------------
 
-    // insert processes from the input file into the queue
-    InsertProcessQueue(queue, inputFilename);
-    globalQueuePtr = &queue;
+AdmissionControl DefaultAdmissionControl()
+{
+    AdmissionControl admission;
+    admission.maxReadyDepth = 0;
+    admission.maxPredictedWait = 0;
+    admission.deferDelay = 1;
+    admission.maxDeferrals = 3;
+    return admission;
+}
 
-   // define the signals
-    struct sigaction sa;
-    sa.sa_handler = TerminationHandler;
-    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+SchedulerConfig DefaultSchedulerConfig(const std::string &policy, double quantum)
+{
+    SchedulerConfig config;
+    config.policy = policy;
+    config.quantum = quantum;
+    config.switchCost = 0;
+    config.adaptivePercentile = 0;
+    config.adaptiveWindow = 0;
+    config.admission = DefaultAdmissionControl();
+    return config;
+}
 
-    if (sigaction(SIGCHLD, &sa, nullptr) == -1)
+void ApplyConfig(Scheduler &scheduler, const SchedulerConfig &config)
+{
+    scheduler.SetContextSwitchCost(config.switchCost);
+    if (config.adaptivePercentile > 0)
     {
+        scheduler.SetAdaptiveQuantum(config.adaptivePercentile, config.adaptiveWindow);
+    }
+    scheduler.SetAdmissionControl(config.admission);
+    if (!config.innerPolicy.empty())
+    {
+        scheduler.SetInnerPolicy(config.innerPolicy);
+    }
+    for (const std::pair<std::string, double> &weight : config.groupWeights)
+    {
+        scheduler.SetGroupWeight(weight.first, weight.second);
+    }
+}
 
-        perror("Error setting up signal TerminationHandler");
-        exit(1);
-   }
+double CalculateExecutionTime(double quantum, double remain_time)
+{
+    double executionTime;
+    if (quantum > remain_time)
+    {
+        executionTime = remain_time;
+    }
     else
     {
-       std::cout << "Signal TerminationHandler set up." << std::endl;
-   }
+        executionTime = quantum;
+    }
+
+    return executionTime;
+}
 
-    // Set up signal handler for SIGCONT (ContinueHandler)
-    struct sigaction continueAction;
-    continueAction.sa_handler = ContinueHandler;
-    continueAction.sa_flags = 0;
-    if (sigaction(SIGCONT, &continueAction, nullptr) == -1)
+void ProcessInfo(std::ostream &out, const ProcessProfile &process)
+{
+    out << "-----------------------------------------\n";
+    out << "| Process name: " << process.name << "           |\n";
+    out << "| Process id: " << process.pid << "                      |\n";
+    out << "| Arrival Time: " << process.arrivalTime << "    seconds            |\n";
+    out << "| Start Time: " << process.startTime << "    seconds              |\n";
+    out << "| End Time: " << process.endTime << "         seconds           |\n";
+    out << "| Burst Time: " << process.burst_time << "     seconds             |\n";
+    out << "| I/O Time: " << process.io_time << "       seconds             |\n";
+    out << "| Remaining Time: " << process.remain_time << "     seconds             |\n";
+    out << "| Turnaround Time: " << process.turnaround_time << " seconds            |\n";
+    out << "| Waiting Time: " << process.total_waiting_time << " seconds               |\n";
+    out << "-----------------------------------------\n" << std::flush;
+}
+
+void PrintStats(std::ostream &out, const SchedulerStats &stats)
+{
+    if (stats.failed > 0)
     {
-        perror("Error setting up signal ContinueHandler");
-        exit(1);
-   }
-    else
+        out << "\nFailed Processes: " << stats.failed;
+    }
+    if (stats.completed == 0)
     {
-       std::cout << "Signal ContinueHandler set up."
-                  << std::endl;
-   }
+        out << "\nNo process completed.\n";
+        return;
+    }
+
+    double averageWaitTime = stats.totalWaitingTime / stats.completed;
+    double averageTurnaroundTime = stats.totalTurnaroundTime / stats.completed;
+
+    out << "\nAverage Waiting Time: " << averageWaitTime << " seconds";
+    out << "\nAverage Turnaround Time: " << averageTurnaroundTime << " seconds";
+    out << "\nCPU Utilization: " << CpuUtilization(stats) * 100 << " %";
+    out << "\nDevice Utilization: " << DeviceUtilization(stats) * 100 << " %";
+    out << "\nThroughput: " << Throughput(stats) << " jobs/second";
+    out << "\nContext Switches: " << stats.contextSwitches
+        << " (overhead " << SwitchOverhead(stats) * 100 << " % of the total time)";
+    out << "\n";
+}
 
-    struct sigaction stopAction;
-    stopAction.sa_handler = StopHandler;
-    stopAction.sa_flags = 0;
-    if (sigaction(SIGTSTP, &stopAction, nullptr) == -1)
+void PrintReport(std::ostream &out, const Scheduler &scheduler)
+{
+    PrintStats(out, scheduler.Stats());
+    if (scheduler.AdaptiveQuantum())
     {
-        perror("Error setting up signal StopHandler");
-        exit(1);
-   }
-    else
+        out << "Final Quantum: " << scheduler.Quantum() * 1000 << " milliseconds\n";
+    }
+    if (!scheduler.Admission().action.empty())
     {
-       std::cout << "Signal StopHandler set up.\n"
-                  << std::endl;
-   }
-
-
-    // apply the scheduling policy based on the user preference
-    if (policy == "FCFS")
-    {
-        FCFS(queue);
-        sleep(4);
-   }
-    else if (policy == "SJF")
-    {
-        SJF(queue);
-        sleep(4);
-   } 
-     else if (policy == "RR")
-     {
-        RR(queue);
-        sleep(4);
-    }/*
-     else if (policy == "PRIO")
-     {
-         PRIO(queue);
-         sleep(4);
-    }*/
-    else
+        PrintAdmissionStats(out, scheduler);
+    }
+
+    std::vector<GroupStats> groups = scheduler.GroupStatistics();
+    if (groups.size() > 1)
     {
-       std::cout << "Invalid policy." << std::endl;
-        return 1;
-   }
+        PrintGroupStats(out, groups);
+    }
+}
 
-   std:cout<<" #################### CPU SCHEDULER IS DONE !!!!!!!!!!!!!!  #######################";
+void PrintGroupStats(std::ostream &out, const std::vector<GroupStats> &groups)
+{
+    out << "\nPer group:\n";
+    for (const GroupStats &group : groups)
+    {
+        out << "  " << group.name << " (weight " << group.weight << "): "
+            << group.completed << "/" << group.processCount << " completed, CPU " << group.cpuTime << " seconds";
+        if (group.completed > 0)
+        {
+            out << ", average waiting " << group.totalWaitingTime / group.completed << " seconds"
+                << ", average turnaround " << group.totalTurnaroundTime / group.completed << " seconds";
+        }
+        out << "\n";
+    }
+}
+
+void PrintAdmissionStats(std::ostream &out, const Scheduler &scheduler)
+{
+    SchedulerStats stats = scheduler.Stats();
 
-    return 0;
+    out << "\nAdmission (" << scheduler.Admission().action << "): " << stats.admitted << " admitted, "
+        << stats.rejected << " rejected, " << stats.deferrals << " deferrals, " << stats.deprioritized
+        << " deprioritized";
+    out << "\nTurnaround of admitted processes: p50 " << scheduler.TurnaroundPercentile(0.5)
+        << " seconds, p99 " << scheduler.TurnaroundPercentile(0.99) << " seconds\n";
+}
+
+double CpuUtilization(const SchedulerStats &stats)
+{
+    return stats.time > 0 ? stats.cpuBusyTime / stats.time : 0;
+}
+
+double DeviceUtilization(const SchedulerStats &stats)
+{
+    return stats.time > 0 ? stats.deviceBusyTime / stats.time : 0;
+}
+
+double Throughput(const SchedulerStats &stats)
+{
+    return stats.time > 0 ? double(stats.completed) / stats.time : 0;
+}
+
+double SwitchOverhead(const SchedulerStats &stats)
+{
+    return stats.time > 0 ? stats.switchTime / stats.time : 0;
 }
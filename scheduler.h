@@ -0,0 +1,286 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "metrics.h"
+#include "process_queue.h"
+
+// ----------------------------------   SCHEDULER LIBRARY   --------------------------------------
+//
+// A Scheduler owns its own ready queue, clock and statistics, so any number of
+// them can live in one process. By default every dispatch is simulated on a
+// virtual clock; attach an Executor to have the slices carried out for real.
+
+struct SchedulerStats
+{
+    int processCount;          // processes submitted so far
+    int completed;             // processes that finished their burst
+    int failed;                // processes whose execution died before they finished
+    int dispatches;            // slices handed out
+    double totalWaitingTime;
+    double totalTurnaroundTime;
+    double time;               // current value of the scheduler clock
+    double cpuBusyTime;        // time the CPU spent running slices
+    double deviceBusyTime;     // time the I/O device spent serving requests
+    int contextSwitches;       // dispatches that changed the running process
+    double switchTime;         // clock time charged for those switches
+    int admitted;              // arrivals that entered the ready queue
+    int rejected;              // arrivals turned away by admission control
+    int deferrals;             // times an arrival was postponed
+    int deprioritized;         // arrivals admitted at the lowest priority
+};
+
+// turnaround histogram buckets, four per doubling from 1 microsecond to about 10^9 seconds
+static const int kTurnaroundBuckets = 200;
+
+// what happens to an arrival that would overload the ready queue
+struct AdmissionControl
+{
+    std::string action;        // "reject", "defer" or "deprioritize", empty admits everything
+    size_t maxReadyDepth;      // 0: no bound on the ready queue
+    double maxPredictedWait;   // seconds, 0: no bound on the predicted waiting time
+    double deferDelay;         // defer: seconds until the arrival is tried again
+    int maxDeferrals;          // defer: attempts before the arrival is rejected
+};
+
+// admits everything
+AdmissionControl DefaultAdmissionControl();
+
+// totals of the processes that share a group (tenant)
+struct GroupStats
+{
+    std::string name;
+    double weight;             // share of the CPU relative to the other groups under FAIR
+    int processCount;
+    int completed;
+    double totalWaitingTime;
+    double totalTurnaroundTime;
+    double cpuTime;            // time the group's processes spent on the CPU
+};
+
+// carries out the slices chosen by the scheduler
+class Executor
+{
+public:
+    virtual ~Executor() {}
+
+    // run the process for slice seconds; the process is still in the queue.
+    // false when it died and can not run again, it then leaves the queue as failed
+    virtual bool Dispatch(ProcessProfile &process, double slice) = 0;
+
+    // the process has used up its burst and is about to leave the queue;
+    // false when it died before it got through the burst
+    virtual bool Complete(ProcessProfile &process) = 0;
+
+    // nothing is ready, the CPU stays idle while the device works
+    virtual void Idle(double duration) {}
+
+    // the process entered the scheduler, before its first dispatch;
+    // false when it can not be started, it then leaves the queue as failed
+    virtual bool Admit(ProcessProfile &process) { return true; }
+};
+
+// settings a driver applies to every Scheduler it creates, e.g. one per batch file
+struct SchedulerConfig
+{
+    std::string policy;
+    double quantum;            // seconds
+    double switchCost;         // seconds per context switch
+    std::string innerPolicy;   // FAIR only, empty keeps RR
+    std::vector<std::pair<std::string, double>> groupWeights;
+    double adaptivePercentile; // 0: fixed quantum
+    size_t adaptiveWindow;
+    AdmissionControl admission;
+};
+
+// a fixed quantum, no switch cost, no groups
+SchedulerConfig DefaultSchedulerConfig(const std::string &policy, double quantum);
+
+class Scheduler
+{
+public:
+    // quantum is in seconds and used by RR, PRIO and FAIR with an RR or PRIO inner policy
+    Scheduler(const std::string &policy, double quantum);
+    ~Scheduler();
+
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    static bool ValidPolicy(const std::string &policy);
+    // policies that can schedule the processes inside a FAIR group
+    static bool ValidInnerPolicy(const std::string &policy);
+
+    // the process keeps its arrivalTime; one that lies ahead of the clock waits
+    // until the clock gets there, then admission control decides
+    void Submit(const ProcessProfile &process);
+    void Submit(const std::string &name, int priority, double burstTime);
+
+    // reads "<process_name> <priority> <cpu_burst> [<io_burst> <cpu_burst>]..." lines,
+    // returns how many were submitted or -1 when the file cannot be opened
+    int LoadFile(const std::string &filename);
+
+    // dispatch a single slice, idling first if every process is blocked on I/O;
+    // false once there is nothing left to run
+    bool Step();
+    void Run();
+
+    SchedulerStats Stats() const;
+    double Time() const { return stats.time; }
+    // no process is ready, blocked or yet to arrive
+    bool Idle() const;
+    // moves the clock forward over a period in which nothing was ready to run
+    void AdvanceClock(double time);
+
+    const std::string &Policy() const { return policy; }
+    // the current quantum, which moves with the bursts when it is adaptive
+    double Quantum() const { return quantum; }
+
+    // after every finished CPU burst the quantum becomes the given percentile (0-100]
+    // of the last window CPU bursts, but never so short that switching dominates
+    void SetAdaptiveQuantum(double percentile, size_t window);
+    bool AdaptiveQuantum() const { return adaptivePercentile > 0; }
+
+    // FAIR divides the CPU among the groups by weight and runs innerPolicy
+    // inside each group (RR by default); call it before submitting
+    void SetInnerPolicy(const std::string &innerPolicy);
+    const std::string &InnerPolicy() const { return innerPolicy; }
+    // weights default to 1, groups are created when their first process arrives
+    void SetGroupWeight(const std::string &group, double weight);
+    std::vector<GroupStats> GroupStatistics() const;
+
+    static bool ValidAdmissionAction(const std::string &action);
+    // bounds the ready queue depth and / or the predicted waiting time of every
+    // arrival; deprioritize only has an effect on PRIO and FAIR with inner PRIO
+    void SetAdmissionControl(const AdmissionControl &admission) { this->admission = admission; }
+    const AdmissionControl &Admission() const { return admission; }
+    // time the process would wait in its ready queue before its first slice,
+    // estimated from the bursts ahead of it under the policy
+    double PredictWait(const ProcessProfile &process) const;
+    // nearest rank turnaround percentile of the finished processes, interpolated in a
+    // log-bucket histogram and never beyond the turnarounds seen; 0 before anything finished
+    double TurnaroundPercentile(double fraction) const;
+    // the settings this scheduler runs with, as a driver would pass them to ApplyConfig
+    SchedulerConfig Config() const;
+
+    // clock time charged whenever a dispatch switches to another process (default 0)
+    void SetContextSwitchCost(double seconds) { switchCost = seconds; }
+    double ContextSwitchCost() const { return switchCost; }
+
+    // not owned, may be nullptr (the default) for pure simulation; processes
+    // already submitted are admitted to the executor right away, failing those it refuses
+    void SetExecutor(Executor *executor);
+    // not owned, may be nullptr (the default); live counters are published here
+    void SetMetrics(SchedulerMetrics *metrics);
+    // per process reports are written here when set
+    void SetLog(std::ostream *log) { this->log = log; }
+    // called with every process that finishes or fails (status FAILED), right before it leaves the queue
+    void SetCompletionCallback(std::function<void(const ProcessProfile &)> onComplete) { this->onComplete = onComplete; }
+
+    // saves the queues, PCBs, clock and statistics between two steps; false on I/O errors
+    bool SaveCheckpoint(const std::string &filename) const;
+    // loads a saved state into a scheduler nothing was submitted to yet; the policy and
+    // settings stay those of this scheduler, so one state can continue under several
+    // policies. Only for the virtual clock, no executor is told about the processes.
+    // false when the file is not a readable checkpoint, the scheduler is then only fit to be discarded
+    bool RestoreCheckpoint(const std::string &filename);
+    // Run() saves a checkpoint every everyDispatches dispatches, 0 turns it off
+    void SetCheckpointing(const std::string &filename, int everyDispatches);
+
+private:
+    // a FAIR group keeps its own ready queue and the CPU time it received scaled by its weight
+    struct ProcessGroup
+    {
+        GroupStats stats;
+        double virtualTime;
+        Queue ready;
+        int metricsSlot;       // -1 until metrics are attached
+    };
+
+    int GroupFor(const std::string &name);
+    Queue &ReadyQueueOf(const ProcessProfile &process);
+    const Queue &ReadyQueueOf(const ProcessProfile &process) const;
+    void AdmitArrivals(double until);
+    void Arrive(ProcessProfile &process, double arrival);
+    bool Overloaded(const ProcessProfile &process) const;
+    void MakeReady(Node *node);
+    void RemoveReady(Node *node);
+    bool ReadyEmpty() const;
+    Node *SelectFrom(const Queue &ready) const;
+    void ChargeGroup(const ProcessProfile &process, double executionTime);
+    void ObserveBurst(double length);
+    Node *SelectNext();
+    double SliceFor(const ProcessProfile &process) const;
+    void Finish(Node *node);
+    void Fail(Node *node);
+    void StartIo(Node *node);
+    double NextIoCompletion() const;
+    void ServiceDevice(double until);
+
+    std::string policy;
+    // policy applied to the processes of one ready queue, the policy itself except under FAIR
+    std::string innerPolicy;
+    double quantum;
+    double switchCost;
+    double adaptivePercentile; // 0: the quantum stays fixed
+    // ring of the most recent CPU burst lengths, recentNext is the slot written next
+    std::vector<double> recentBursts;
+    size_t adaptiveWindow;
+    size_t recentNext;
+    int nextId;
+    int lastDispatched;        // id of the process that held the CPU last, -1 for none
+    Queue queue;
+    std::vector<ProcessGroup> groups;
+    std::unordered_map<std::string, int> groupIndex;
+    std::unordered_map<std::string, double> groupWeights;
+    // FAIR: groups with ready processes ordered by virtual time, so picking one is O(log groups)
+    std::set<std::pair<double, int>> activeGroups;
+    // virtual time of the group picked last, a group that had nothing ready restarts from here
+    double fairClock;
+    // processes whose arrival (or retry after a deferral) lies ahead of the clock, by time
+    std::multimap<double, ProcessProfile> arrivals;
+    AdmissionControl admission;
+    size_t readyCount;         // processes in all ready queues
+    long turnaroundBuckets[kTurnaroundBuckets];
+    double shortestTurnaround;
+    double longestTurnaround;
+    // processes waiting for the single I/O device, served in FCFS order
+    Queue blocked;
+    double deviceFreeAt;
+    SchedulerStats stats;
+    Executor *executor;
+    SchedulerMetrics *metrics;
+    std::ostream *log;
+    std::function<void(const ProcessProfile &)> onComplete;
+    std::string checkpointFile;
+    int checkpointEvery;
+    int lastCheckpoint;        // dispatch count of the last checkpoint written
+};
+
+// everything but the policy and quantum, which the constructor takes
+void ApplyConfig(Scheduler &scheduler, const SchedulerConfig &config);
+
+double CalculateExecutionTime(double quantum, double remain_time);
+
+void ProcessInfo(std::ostream &out, const ProcessProfile &process);
+void PrintStats(std::ostream &out, const SchedulerStats &stats);
+void PrintGroupStats(std::ostream &out, const std::vector<GroupStats> &groups);
+void PrintAdmissionStats(std::ostream &out, const Scheduler &scheduler);
+// everything printed at the end of a run: statistics, final adaptive quantum, admission and groups
+void PrintReport(std::ostream &out, const Scheduler &scheduler);
+
+// fractions of the elapsed time, and finished processes per second
+double CpuUtilization(const SchedulerStats &stats);
+double DeviceUtilization(const SchedulerStats &stats);
+double Throughput(const SchedulerStats &stats);
+// fraction of the elapsed time spent switching between processes
+double SwitchOverhead(const SchedulerStats &stats);
+
+#endif
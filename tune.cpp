@@ -0,0 +1,109 @@
+#include "tune.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "batch.h"
+
+bool ValidTuneObjective(const std::string &objective)
+{
+    return objective == "mean" || objective == "p99";
+}
+
+std::vector<double> CandidateQuanta(const std::vector<ProcessProfile> &workload, int count)
+{
+    double shortest = 0;
+    double longest = 0;
+    for (const ProcessProfile &process : workload)
+    {
+        // even entries are CPU bursts, odd ones I/O
+        for (size_t i = 0; i < process.bursts.size(); i += 2)
+        {
+            if (shortest == 0 || process.bursts[i] < shortest)
+            {
+                shortest = process.bursts[i];
+            }
+            longest = std::max(longest, process.bursts[i]);
+        }
+    }
+
+    std::vector<double> candidates;
+    if (longest == 0)
+    {
+        return candidates;
+    }
+
+    // a quantum at or above the longest burst already behaves like FCFS
+    double low = shortest / 2;
+    double ratio = count > 1 ? std::pow(longest / low, 1.0 / (count - 1)) : 1;
+    for (int i = 0; i < count; i++)
+    {
+        candidates.push_back(i + 1 == count ? longest : low * std::pow(ratio, i));
+    }
+    return candidates;
+}
+
+// ----------------------------------   TRIALS   --------------------------------------
+
+static void RunTrial(const SchedulerConfig &config, const std::vector<ProcessProfile> &workload, QuantumTrial &trial)
+{
+    // every trial gets a private scheduler, nothing is shared between the workers
+    Scheduler scheduler(config.policy, trial.quantum);
+    ApplyConfig(scheduler, config);
+
+    for (const ProcessProfile &process : workload)
+    {
+        scheduler.Submit(process);
+    }
+    scheduler.Run();
+
+    // the same p99 the batch results and the admission statistics report
+    SchedulerStats stats = scheduler.Stats();
+    trial.completed = stats.completed;
+    trial.meanTurnaround = stats.completed > 0 ? stats.totalTurnaroundTime / stats.completed : 0;
+    trial.p99Turnaround = scheduler.TurnaroundPercentile(0.99);
+}
+
+std::vector<QuantumTrial> TuneQuantum(const SchedulerConfig &config, const std::vector<ProcessProfile> &workload,
+                                      const std::vector<double> &candidates, unsigned threads)
+{
+    std::vector<QuantumTrial> trials(candidates.size());
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        trials[i].quantum = candidates[i];
+    }
+
+    // the quantum under test must stay fixed
+    SchedulerConfig fixed = config;
+    fixed.adaptivePercentile = 0;
+
+    ForEachParallel(trials.size(), threads, [&](size_t index) { RunTrial(fixed, workload, trials[index]); });
+
+    return trials;
+}
+
+size_t BestTrial(const std::vector<QuantumTrial> &trials, const std::string &objective)
+{
+    size_t best = 0;
+    for (size_t i = 1; i < trials.size(); i++)
+    {
+        double value = objective == "p99" ? trials[i].p99Turnaround : trials[i].meanTurnaround;
+        double bestValue = objective == "p99" ? trials[best].p99Turnaround : trials[best].meanTurnaround;
+        // a longer quantum with the same result costs fewer switches
+        if (value <= bestValue)
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void PrintTrials(std::ostream &out, const std::vector<QuantumTrial> &trials, size_t best)
+{
+    out << "Quantum (ms)    Mean turnaround (s)    p99 turnaround (s)\n";
+    for (size_t i = 0; i < trials.size(); i++)
+    {
+        out << trials[i].quantum * 1000 << "\t\t" << trials[i].meanTurnaround << "\t\t\t" << trials[i].p99Turnaround
+            << (i == best ? "\t<- best" : "") << "\n";
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef TUNE_H
+#define TUNE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "scheduler.h"
+
+// ----------------------------------   QUANTUM OPTIMIZER   --------------------------------------
+
+struct QuantumTrial
+{
+    double quantum;            // seconds
+    double meanTurnaround;
+    double p99Turnaround;
+    int completed;
+};
+
+// "mean" or "p99" turnaround
+bool ValidTuneObjective(const std::string &objective);
+
+// count quanta spaced evenly on a log scale between half the shortest and the longest CPU burst
+std::vector<double> CandidateQuanta(const std::vector<ProcessProfile> &workload, int count);
+
+// simulates the workload once per candidate quantum with the rest of config, spread
+// over a pool of worker threads; trials come back in the order of the candidates
+std::vector<QuantumTrial> TuneQuantum(const SchedulerConfig &config, const std::vector<ProcessProfile> &workload,
+                                      const std::vector<double> &candidates, unsigned threads);
+
+// index of the trial with the lowest mean or p99 turnaround, ties go to the longer quantum
+size_t BestTrial(const std::vector<QuantumTrial> &trials, const std::string &objective);
+
+void PrintTrials(std::ostream &out, const std::vector<QuantumTrial> &trials, size_t best);
+
+#endif
@@ -0,0 +1,73 @@
+#include "unix_socket.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+// a failed accept() is retried after this long, a pending connection would otherwise make it spin
+static const std::chrono::milliseconds kAcceptBackoff(100);
+
+int OpenListeningSocket(const std::string &path)
+{
+    struct sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path is too long: " << path << std::endl;
+        return -1;
+    }
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd == -1)
+    {
+        perror("Error creating socket");
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(path.c_str());
+
+    if (bind(listenFd, (struct sockaddr *)&address, sizeof(address)) == -1 || listen(listenFd, SOMAXCONN) == -1)
+    {
+        perror("Error binding socket");
+        close(listenFd);
+        return -1;
+    }
+
+    return listenFd;
+}
+
+void AcceptConnections(int listenFd, const std::function<bool()> &keepRunning,
+                       const std::function<void(int)> &onClient)
+{
+    while (keepRunning())
+    {
+        struct pollfd listener = {listenFd, POLLIN, 0};
+        // wake up regularly to notice a stop request
+        if (poll(&listener, 1, 200) <= 0)
+        {
+            continue;
+        }
+
+        int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd == -1)
+        {
+            // e.g. EMFILE: the connection stays pending until descriptors have been closed
+            if (errno != EINTR && errno != ECONNABORTED)
+            {
+                std::this_thread::sleep_for(kAcceptBackoff);
+            }
+            continue;
+        }
+
+        onClient(clientFd);
+    }
+}
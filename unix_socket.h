@@ -0,0 +1,18 @@
+#ifndef UNIX_SOCKET_H
+#define UNIX_SOCKET_H
+
+#include <functional>
+#include <string>
+
+// ----------------------------------   UNIX DOMAIN SOCKETS   --------------------------------------
+
+// binds a Unix domain stream socket at path, replacing a stale one; -1 on errors
+int OpenListeningSocket(const std::string &path);
+
+// accepts connections on listenFd until keepRunning() returns false, which is checked
+// at least every 200 ms; every accepted descriptor is handed to onClient, which owns it
+// from then on. A failed accept (e.g. EMFILE) is retried after a short pause.
+void AcceptConnections(int listenFd, const std::function<bool()> &keepRunning,
+                       const std::function<void(int)> &onClient);
+
+#endif